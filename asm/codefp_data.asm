@@ -0,0 +1,19 @@
+	XOR	R0 R0 R0
+	XOR	R1 R1 R1
+	ADDI	R2 R0 0xA000
+	ADDI	R3 R0 0xB020
+T1:	LWS	F4 0(R2)
+	BLTZ	R4 T2	
+	SWS	F4 0(R3)
+	SUBI	R3 R3 0x4 	
+T2:	ADDS	F1 F1 F4
+     	ADDI	R2 R2 0x4
+   	SUBI	R5 R2 0XA020
+     	BNEZ	R5 T1
+     	SWS  	F1 0(R2)
+	SW	R3 4(R2)
+	EOP
+	.data 0xA000
+	.float 0.5 1.0 1.5 2.0 2.5 3.0 3.5 4.0
+	.data 0xB000
+	.space 0x28
@@ -0,0 +1,13 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0xB000
+	ADDI	R3 R0 4
+T1:	LWS	F1 0(R1)
+	LWS	F2 0(R2)
+	FMADDS	F3 F1 F2 F3
+	ADDI	R1 R1 0x4
+	ADDI	R2 R2 0x4
+	SUBI	R3 R3 1
+	BNEZ	R3 T1
+	SWS	F3 0(R1)
+	EOP
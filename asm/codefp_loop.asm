@@ -0,0 +1,10 @@
+	XOR	R0 R0 R0
+	ADDI	R2 R0 0xA000
+	ADDI	R3 R0 8
+	LOOP	R3
+	LWS	F4 0(R2)
+	ADDS	F1 F1 F4
+	ADDI	R2 R2 0x4
+	ENDLOOP
+	SWS	F1 0(R2)
+	EOP
@@ -0,0 +1,19 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 1024
+L1:	LWS	F2 0(R1)
+	MULTS	F3 F2 F2
+	ADDS	F1 F1 F3
+	SWS	F3 0x1000(R1)
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L1
+	ADDI	R2 R0 1024
+L2:	ADDI	R3 R3 1
+	ADDI	R4 R4 2
+	XOR	R5 R3 R4
+	SUBI	R2 R2 1
+	BNEZ	R2 L2
+	SWS	F1 0(R1)
+	SW	R5 4(R1)
+	EOP
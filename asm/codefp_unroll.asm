@@ -0,0 +1,13 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0xB000
+T1:	LWS	F1 0(R1)
+	LWS	F2 0(R2)
+	MULTS	F3 F1 F10
+	ADDS	F4 F3 F2
+	SWS	F4 0(R2)
+	ADDI	R1 R1 0x4
+	ADDI	R2 R2 0x4
+	SUBI	R5 R1 0xA02C
+	BNEZ	R5 T1
+	EOP
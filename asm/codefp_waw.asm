@@ -0,0 +1,13 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	LWS	F1 0(R1)
+	LWS	F5 4(R1)
+	DIVS	F2 F1 F10
+	ADDS	F2 F1 F5
+	SWS	F2 8(R1)
+	MULTS	F2 F5 F5
+	SWS	F2 12(R1)
+	ADDS	F3 F1 F1
+	ADDS	F2 F3 F5
+	SWS	F2 16(R1)
+	EOP
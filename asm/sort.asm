@@ -29,3 +29,5 @@ END_IF:	ADDI R6 R6 4
 	SUBI R10 R1 9
 	BNEZ R10 OLOOP
 EOP	
+	.data 0xA000
+	.word 7 3 10 1 9 -2 5 8 2 6
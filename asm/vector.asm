@@ -0,0 +1,13 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0xB000
+	ADDI	R3 R0 0xC000
+	ADDI	R4 R0 8
+	LV	V1 0(R1)
+	LV	V2 0(R2)
+	MULV	V3 V1 V2
+	ADDV	V4 V3 V1
+	SV	V4 0(R3)
+	LVWS	V5 0(R1) R4
+	SVWS	V5 0x40(R3) R4
+	EOP
@@ -0,0 +1,15 @@
+	XOR	R0 R0 R0
+	LW	R1 0xA100(R0)
+	LW	R2 0xA104(R0)
+	LWS	F1 0xA000(R0)
+	ADD	R11 R0 R0
+L_CHASE:	LWS	F10 0x4(R1)
+	LW	R21 0x4(R2)
+	LW	R1 0x0(R1)
+	LW	R2 0x0(R2)
+	ADDS	F1 F1 F10
+	ADD	R11 R11 R21
+	BNEZ	R1 L_CHASE
+	SWS	F1 0xA010(R0)
+	SW	R11 0xA014(R0)
+	EOP
@@ -0,0 +1,9 @@
+	XOR	R0 R0 R0
+	LW	R1 0xA100(R0)
+	ADD	R10 R0 R0
+L_CHASE:	LW	R20 0x4(R1)
+	LW	R1 0x0(R1)
+	ADD	R10 R10 R20
+	BNEZ	R1 L_CHASE
+	SW	R10 0xA010(R0)
+	EOP
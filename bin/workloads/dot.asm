@@ -0,0 +1,31 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R2 R0 1024
+	LWS	F1 0xA000(R0)
+	LWS	F2 0xA000(R0)
+	LWS	F3 0xA000(R0)
+	LWS	F4 0xA000(R0)
+L_DOT:	LWS	F10 0x0(R1)
+	LWS	F11 0x1000(R1)
+	LWS	F12 0x2000(R1)
+	LWS	F13 0x3000(R1)
+	LWS	F20 0x4000(R1)
+	LWS	F21 0x5000(R1)
+	LWS	F22 0x6000(R1)
+	LWS	F23 0x7000(R1)
+	MULTS	F10 F10 F20
+	MULTS	F11 F11 F21
+	MULTS	F12 F12 F22
+	MULTS	F13 F13 F23
+	ADDS	F1 F1 F10
+	ADDS	F2 F2 F11
+	ADDS	F3 F3 F12
+	ADDS	F4 F4 F13
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_DOT
+	ADDS	F1 F1 F2
+	ADDS	F1 F1 F3
+	ADDS	F1 F1 F4
+	SWS	F1 0xA010(R0)
+	EOP
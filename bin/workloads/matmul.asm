@@ -0,0 +1,45 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R3 R0 0xB300
+	ADDI	R4 R0 24
+L_ROW:	ADDI	R2 R0 0xAA00
+	ADDI	R5 R0 24
+L_COL:	ADD	R7 R1 R0
+	ADD	R8 R2 R0
+	ADDI	R6 R0 6
+	LWS	F1 0xA000(R0)
+	LWS	F2 0xA000(R0)
+	LWS	F3 0xA000(R0)
+	LWS	F4 0xA000(R0)
+L_INNER:	LWS	F10 0x0(R7)
+	LWS	F11 0x4(R7)
+	LWS	F12 0x8(R7)
+	LWS	F13 0xC(R7)
+	LWS	F20 0x0(R8)
+	LWS	F21 0x60(R8)
+	LWS	F22 0xC0(R8)
+	LWS	F23 0x120(R8)
+	MULTS	F10 F10 F20
+	MULTS	F11 F11 F21
+	MULTS	F12 F12 F22
+	MULTS	F13 F13 F23
+	ADDS	F1 F1 F10
+	ADDS	F2 F2 F11
+	ADDS	F3 F3 F12
+	ADDS	F4 F4 F13
+	ADDI	R7 R7 0x10
+	ADDI	R8 R8 0x180
+	SUBI	R6 R6 1
+	BNEZ	R6 L_INNER
+	ADDS	F1 F1 F2
+	ADDS	F1 F1 F3
+	ADDS	F1 F1 F4
+	SWS	F1 0x0(R3)
+	ADDI	R3 R3 0x4
+	ADDI	R2 R2 0x4
+	SUBI	R5 R5 1
+	BNEZ	R5 L_COL
+	ADDI	R1 R1 0x60
+	SUBI	R4 R4 1
+	BNEZ	R4 L_ROW
+	EOP
@@ -0,0 +1,39 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R2 R0 512
+	LWS	F1 0xA000(R0)
+	LWS	F2 0xA000(R0)
+	LWS	F3 0xA000(R0)
+	LWS	F4 0xA000(R0)
+	ADD	R14 R0 R0
+	ADD	R15 R0 R0
+	ADD	R16 R0 R0
+	ADD	R17 R0 R0
+L_REDUCE:	LWS	F10 0x0(R1)
+	LWS	F11 0x800(R1)
+	LWS	F12 0x1000(R1)
+	LWS	F13 0x1800(R1)
+	LW	R24 0x2000(R1)
+	LW	R25 0x2800(R1)
+	LW	R26 0x3000(R1)
+	LW	R27 0x3800(R1)
+	ADDS	F1 F1 F10
+	ADDS	F2 F2 F11
+	ADDS	F3 F3 F12
+	ADDS	F4 F4 F13
+	ADD	R14 R14 R24
+	ADD	R15 R15 R25
+	ADD	R16 R16 R26
+	ADD	R17 R17 R27
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_REDUCE
+	SWS	F1 0xA010(R0)
+	SWS	F2 0xA014(R0)
+	SWS	F3 0xA018(R0)
+	SWS	F4 0xA01C(R0)
+	SW	R14 0xA020(R0)
+	SW	R15 0xA024(R0)
+	SW	R16 0xA028(R0)
+	SW	R17 0xA02C(R0)
+	EOP
@@ -0,0 +1,23 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R2 R0 1024
+	ADD	R10 R0 R0
+	ADD	R11 R0 R0
+	ADD	R12 R0 R0
+	ADD	R13 R0 R0
+L_REDUCE:	LW	R20 0x0(R1)
+	LW	R21 0x1000(R1)
+	LW	R22 0x2000(R1)
+	LW	R23 0x3000(R1)
+	ADD	R10 R10 R20
+	ADD	R11 R11 R21
+	ADD	R12 R12 R22
+	ADD	R13 R13 R23
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_REDUCE
+	SW	R10 0xA010(R0)
+	SW	R11 0xA014(R0)
+	SW	R12 0xA018(R0)
+	SW	R13 0xA01C(R0)
+	EOP
@@ -0,0 +1,18 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 127
+L_OUTER:	ADDI	R4 R0 0xA100
+	ADD	R2 R1 R0
+	LW	R3 0x0(R4)
+L_INNER:	LW	R5 0x4(R4)
+	SUB	R8 R3 R5
+	BLEZ	R8 L_NOSWAP
+	SW	R5 0x0(R4)
+	SW	R3 0x4(R4)
+	ADD	R5 R3 R0
+L_NOSWAP:	ADD	R3 R5 R0
+	ADDI	R4 R4 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_INNER
+	SUBI	R1 R1 1
+	BNEZ	R1 L_OUTER
+	EOP
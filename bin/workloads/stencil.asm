@@ -0,0 +1,34 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R2 R0 512
+	LWS	F30 0xA004(R0)
+L_STENCIL:	LWS	F5 0x0(R1)
+	LWS	F8 0x808(R1)
+	LW	R11 0x1010(R1)
+	LW	R14 0x1818(R1)
+	LWS	F6 0x4(R1)
+	LWS	F9 0x80C(R1)
+	LW	R12 0x1014(R1)
+	LW	R15 0x181C(R1)
+	LWS	F7 0x8(R1)
+	LWS	F10 0x810(R1)
+	LW	R13 0x1018(R1)
+	LW	R16 0x1820(R1)
+	ADDS	F5 F5 F6
+	ADDS	F8 F8 F9
+	ADD	R11 R11 R12
+	ADD	R14 R14 R15
+	ADDS	F5 F5 F7
+	ADDS	F8 F8 F10
+	ADD	R11 R11 R13
+	ADD	R14 R14 R16
+	MULTS	F5 F5 F30
+	MULTS	F8 F8 F30
+	SWS	F5 0x2020(R1)
+	SWS	F8 0x2820(R1)
+	SW	R11 0x3020(R1)
+	SW	R14 0x3820(R1)
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_STENCIL
+	EOP
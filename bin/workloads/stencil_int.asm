@@ -0,0 +1,19 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA100
+	ADDI	R2 R0 1024
+L_STENCIL:	LW	R5 0x0(R1)
+	LW	R8 0x1008(R1)
+	LW	R6 0x4(R1)
+	LW	R9 0x100C(R1)
+	LW	R7 0x8(R1)
+	LW	R10 0x1010(R1)
+	ADD	R5 R5 R6
+	ADD	R8 R8 R9
+	ADD	R5 R5 R7
+	ADD	R8 R8 R10
+	SW	R5 0x2010(R1)
+	SW	R8 0x3010(R1)
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 1
+	BNEZ	R2 L_STENCIL
+	EOP
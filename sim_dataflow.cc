@@ -0,0 +1,75 @@
+#include "sim_dataflow.h"
+#include <stdlib.h>
+#include <cstring>
+
+using namespace std;
+
+bool is_int_alu(opcode_t opcode);            //sim_pipe_fp.cc
+bool is_fp_alu(opcode_t opcode);             //sim_pipe_fp.cc
+bool is_vector_alu(opcode_t opcode);         //sim_pipe_fp.cc
+bool is_vector_memory(opcode_t opcode);      //sim_pipe_fp.cc
+bool is_vector_store(opcode_t opcode);       //sim_pipe_fp.cc
+char operand_class(opcode_t opcode, unsigned field); //sim_pipe_fp.cc
+
+dataflow_analyzer::dataflow_analyzer(const unsigned latency[NUM_OPCODES], unsigned vector_length) :
+	vector_length(vector_length), last_finish(0), last_node(UNDEFINED){
+	memcpy(this->latency, latency, sizeof(this->latency));
+	producer_t initial = {0, UNDEFINED};
+	for (unsigned r=0; r<REGISTER_FILE_SIZE; r++) int_registers[r] = fp_registers[r] = initial;
+	for (unsigned r=0; r<NUM_VECTOR_REGISTERS; r++) vector_registers[r] = initial;
+}
+
+void dataflow_analyzer::depend(const producer_t &producer, unsigned long long &start, unsigned &predecessor){
+	if (producer.node != UNDEFINED && producer.finish > start){
+		start = producer.finish;
+		predecessor = producer.node;
+	}
+}
+
+void dataflow_analyzer::execute(const instruction_t &instr, unsigned pc, unsigned address, unsigned stride){
+	opcode_t opcode = instr.opcode;
+	unsigned long long start = 0;
+	unsigned predecessor = UNDEFINED;
+	unsigned sources[3] = {instr.src1, instr.src2, instr.src3};
+	for (unsigned field = 1; field <= 3; field++){
+		unsigned reg = sources[field - 1];
+		switch (operand_class(opcode, field)){
+			case 'R': if (reg < REGISTER_FILE_SIZE) depend(int_registers[reg], start, predecessor); break;
+			case 'F': if (reg < REGISTER_FILE_SIZE) depend(fp_registers[reg], start, predecessor); break;
+			case 'V': if (reg < NUM_VECTOR_REGISTERS) depend(vector_registers[reg], start, predecessor); break;
+			default: break;
+		}
+	}
+	bool vector_memory = is_vector_memory(opcode);
+	bool load = (opcode == LW || opcode == LWS || (vector_memory && !is_vector_store(opcode)));
+	bool store = (opcode == SW || opcode == SWS || is_vector_store(opcode));
+	unsigned elements = vector_memory ? vector_length : 1;
+	if (load){
+		for (unsigned k = 0; k < elements; k++){
+			unordered_map<unsigned, producer_t>::iterator it = memory.find((address + k * stride) >> 2);
+			if (it != memory.end()) depend(it->second, start, predecessor);
+		}
+	}
+
+	producer_t result = {start + latency[opcode], (unsigned)nodes.size()};
+	node_t node = {pc, predecessor};
+	nodes.push_back(node);
+	if (store){
+		for (unsigned k = 0; k < elements; k++) memory[(address + k * stride) >> 2] = result;
+	}
+	if (instr.dest < REGISTER_FILE_SIZE){
+		if (is_int_alu(opcode) || opcode == LW) int_registers[instr.dest] = result;
+		else if (is_fp_alu(opcode) || opcode == LWS) fp_registers[instr.dest] = result;
+		else if ((is_vector_alu(opcode) || (vector_memory && !store)) && instr.dest < NUM_VECTOR_REGISTERS) vector_registers[instr.dest] = result;
+	}
+	if (result.finish > last_finish){
+		last_finish = result.finish;
+		last_node = result.node;
+	}
+}
+
+map<unsigned, unsigned long long> dataflow_analyzer::critical_instructions(){
+	map<unsigned, unsigned long long> instances;
+	for (unsigned n = last_node; n != UNDEFINED; n = nodes[n].predecessor) instances[nodes[n].pc]++;
+	return instances;
+}
@@ -0,0 +1,60 @@
+#ifndef SIM_DATAFLOW_H_
+#define SIM_DATAFLOW_H_
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+// dataflow limit study: the dynamic instructions are scheduled as soon as their operands are
+// available, with unlimited execution units, perfect fetch and branch prediction and no name
+// dependences. An instruction depends on the last writer of each of its source registers (integer,
+// floating point and vector register files) and, for loads, on the last store to each word it reads;
+// its result is available "latency[opcode]" cycles after its last operand. The longest chain of
+// dependences (the critical path) bounds the execution time of any pipeline with those latencies
+class dataflow_analyzer{
+public:
+	dataflow_analyzer(const unsigned latency[NUM_OPCODES], unsigned vector_length);
+
+	//adds the next dynamic instruction, executed at "pc"; "address" is the effective address of the
+	//memory operations, "stride" the distance between the elements of the vector ones
+	void execute(const instruction_t &instr, unsigned pc, unsigned address, unsigned stride);
+
+	unsigned long long instructions() { return nodes.size(); }
+
+	//length of the critical path (clock cycles)
+	unsigned long long critical_path() { return last_finish; }
+
+	//instructions per cycle allowed by the dependences
+	double ideal_ipc() { return last_finish ? (double)nodes.size() / last_finish : 0.0; }
+
+	//dynamic instances of each static instruction (PC) on the critical path
+	map<unsigned, unsigned long long> critical_instructions();
+
+private:
+	typedef struct{
+		unsigned long long finish;  //cycle the result is available
+		unsigned node;              //producing instruction (UNDEFINED for the initial state)
+	} producer_t;
+
+	typedef struct{
+		unsigned pc;
+		unsigned predecessor;       //operand producer that finished last (UNDEFINED if none)
+	} node_t;
+
+	void depend(const producer_t &producer, unsigned long long &start, unsigned &predecessor);
+
+	unsigned latency[NUM_OPCODES];
+	unsigned vector_length;
+	producer_t int_registers[REGISTER_FILE_SIZE];
+	producer_t fp_registers[REGISTER_FILE_SIZE];
+	producer_t vector_registers[NUM_VECTOR_REGISTERS];
+	unordered_map<unsigned, producer_t> memory;   //word address -> last store
+	vector<node_t> nodes;
+	unsigned long long last_finish;
+	unsigned last_node;                           //end of the critical path
+};
+
+#endif /*SIM_DATAFLOW_H_*/
@@ -0,0 +1,337 @@
+#include "sim_dse.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <map>
+#include <set>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+exe_unit_t unit_type(opcode_t opcode); //sim_pipe_fp.cc
+
+static const char *dse_unit_names[NUM_UNIT_TYPES] = {"INTEGER", "ADDER", "MULTIPLIER", "DIVIDER", "VECTOR_ADDER", "VECTOR_MULTIPLIER", "VECTOR_MEMORY", "FMA"};
+
+dse_config_t dse_defaults(){
+	dse_config_t config;
+	config.ipc_target = 0.0;
+	config.threads = thread::hardware_concurrency();
+	if (config.threads == 0) config.threads = 1;
+	config.cache = NULL;
+	return config;
+}
+
+void init_exec_units(sim_pipe_fp *mips, const dse_point_t &point){
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++)
+		if (point.units[t] > 0) mips->init_exec_unit((exe_unit_t)t, point.latency[t], point.units[t]);
+}
+
+string point_text(const dse_point_t &point){
+	stringstream ss;
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++)
+		if (point.units[t] > 0) ss << dse_unit_names[t] << " " << point.units[t] << "x" << point.latency[t] << ", ";
+	ss << "memory " << point.memory_latency;
+	return ss.str();
+}
+
+/* ============================  configurations ============================= */
+
+typedef vector<unsigned> dse_key_t;
+
+static dse_key_t point_key(const dse_point_t &point){
+	dse_key_t key(point.units, point.units + NUM_UNIT_TYPES);
+	key.insert(key.end(), point.latency, point.latency + NUM_UNIT_TYPES);
+	key.push_back(point.memory_latency);
+	return key;
+}
+
+/* true if "a" has at least the units of "b", none slower, and a memory not slower */
+static bool dominates(const dse_point_t &a, const dse_point_t &b){
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		if (a.units[t] < b.units[t]) return false;
+		if (b.units[t] > 0 && a.latency[t] > b.latency[t]) return false;
+	}
+	return a.memory_latency <= b.memory_latency;
+}
+
+/* all the configurations of the space, from unit type "type" on; types with no instances have latency 0 */
+static void enumerate_points(const dse_space_t &space, unsigned type, dse_point_t &point, vector<dse_point_t> &points){
+	if (type == NUM_UNIT_TYPES){
+		for (unsigned m=0; m<space.memory_latency.size(); m++){
+			point.memory_latency = space.memory_latency[m];
+			points.push_back(point);
+		}
+		return;
+	}
+	vector<unsigned> units = space.units[type];
+	if (units.empty()) units.push_back(0);
+	for (unsigned u=0; u<units.size(); u++){
+		point.units[type] = units[u];
+		if (units[u] == 0){
+			point.latency[type] = 0;
+			enumerate_points(space, type + 1, point, points);
+			continue;
+		}
+		for (unsigned l=0; l<space.latency[type].size(); l++){
+			point.latency[type] = space.latency[type][l];
+			enumerate_points(space, type + 1, point, points);
+		}
+	}
+}
+
+/* the configuration with the most units of every type, the fastest ones and the fastest memory */
+static dse_point_t richest_point(const dse_space_t &space){
+	dse_point_t point;
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		point.units[t] = 0;
+		for (unsigned u=0; u<space.units[t].size(); u++) point.units[t] = max(point.units[t], space.units[t][u]);
+		point.latency[t] = 0;
+		if (point.units[t] > 0) point.latency[t] = *min_element(space.latency[t].begin(), space.latency[t].end());
+	}
+	point.memory_latency = *min_element(space.memory_latency.begin(), space.memory_latency.end());
+	return point;
+}
+
+/* ============================  simulation ============================= */
+
+/* the setups are serialized (load_program is not reentrant), the simulations run in parallel */
+static mutex setup_lock;
+
+static void simulate_point(dse_setup_t setup, void *arg, dse_point_t point, double *ipc){
+	setup_lock.lock();
+	sim_pipe_fp *mips = setup(point, arg);
+	setup_lock.unlock();
+	mips->run();
+	*ipc = mips->get_IPC();
+	delete mips;
+}
+
+static void simulate_batch(dse_setup_t setup, void *arg, const vector<dse_point_t> &batch, vector<double> &ipc){
+	ipc.assign(batch.size(), 0.0);
+	vector<thread> threads;
+	for (unsigned i=0; i<batch.size(); i++) threads.push_back(thread(simulate_point, setup, arg, batch[i], &ipc[i]));
+	for (unsigned i=0; i<threads.size(); i++) threads[i].join();
+}
+
+/* ============================  memoization ============================= */
+
+static void load_cache(const char *filename, map<dse_key_t, double> &memo){
+	FILE *file = fopen(filename, "r");
+	if (file == NULL) return;   //first search on this workload
+	while (true){
+		dse_key_t key(2 * NUM_UNIT_TYPES + 1);
+		unsigned k = 0;
+		while (k < key.size() && fscanf(file, "%u", &key[k]) == 1) k++;
+		double ipc;
+		if (k == 0 && feof(file)) break;
+		if (k < key.size() || fscanf(file, "%lf", &ipc) != 1){
+			cout << "ERROR:: malformed design-space cache " << filename << endl;
+			exit(-1);
+		}
+		memo[key] = ipc;
+	}
+	fclose(file);
+}
+
+static void save_cache(const char *filename, const map<dse_key_t, double> &memo){
+	FILE *file = fopen(filename, "w");
+	if (file == NULL){
+		cout << "ERROR:: cannot write the design-space cache " << filename << endl;
+		exit(-1);
+	}
+	for (map<dse_key_t, double>::const_iterator it = memo.begin(); it != memo.end(); it++){
+		for (unsigned k=0; k<it->first.size(); k++) fprintf(file, "%u ", it->first[k]);
+		fprintf(file, "%.9g\n", it->second);
+	}
+	fclose(file);
+}
+
+/* ============================  search ============================= */
+
+typedef struct{
+	dse_point_t point;
+	double ipc;
+} dse_known_t;
+
+/* IPC bounds of a configuration from the known ones */
+static void ipc_bounds(const dse_point_t &point, const vector<dse_known_t> &known, double &low, double &high){
+	low = 0.0;
+	high = HUGE_VAL;
+	for (unsigned k=0; k<known.size(); k++){
+		if (dominates(known[k].point, point)) high = min(high, known[k].ipc);
+		if (dominates(point, known[k].point)) low = max(low, known[k].ipc);
+	}
+}
+
+static bool cost_less(const pair<double, unsigned> &a, const pair<double, unsigned> &b){
+	return (a.first < b.first) || (a.first == b.first && a.second < b.second);
+}
+
+dse_result_t explore_design_space(dse_setup_t setup, dse_cost_t cost, void *arg, const dse_space_t &space, const dse_config_t &config){
+	if (config.threads == 0 || space.memory_latency.empty()){
+		cout << "ERROR:: the design-space search needs at least one thread and one memory latency" << endl;
+		exit(-1);
+	}
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		bool instances = false;
+		for (unsigned u=0; u<space.units[t].size(); u++) instances = instances || (space.units[t][u] > 0);
+		if (instances && space.latency[t].empty()){
+			cout << "ERROR:: no latency given for the " << dse_unit_names[t] << " units" << endl;
+			exit(-1);
+		}
+	}
+	dse_result_t result;
+	result.ipc_target = config.ipc_target;
+	result.best = -1;
+	result.simulated = result.memoized = result.inferred = result.pruned = result.infeasible = result.skipped = 0;
+
+	vector<dse_point_t> points;
+	dse_point_t point;
+	enumerate_points(space, 0, point, points);
+	result.points = points.size();
+	vector<pair<double, unsigned> > order;
+	for (unsigned i=0; i<points.size(); i++) order.push_back(make_pair(cost(points[i], arg), i));
+	sort(order.begin(), order.end(), cost_less);
+
+	map<dse_key_t, double> memo;      //simulated IPCs, including the ones of previous searches
+	if (config.cache != NULL) load_cache(config.cache, memo);
+	vector<dse_known_t> known;        //exact IPCs, bounding the others
+	for (map<dse_key_t, double>::iterator it = memo.begin(); it != memo.end(); it++){
+		dse_known_t entry;
+		for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+			entry.point.units[t] = it->first[t];
+			entry.point.latency[t] = it->first[NUM_UNIT_TYPES + t];
+		}
+		entry.point.memory_latency = it->first[2 * NUM_UNIT_TYPES];
+		entry.ipc = it->second;
+		known.push_back(entry);
+	}
+
+	// unit types used by the program; the richest configuration bounds all the others
+	dse_point_t top = richest_point(space);
+	sim_pipe_fp *mips = setup(top, arg);
+	bool used[NUM_UNIT_TYPES] = {false};
+	for (unsigned i=0; i<PROGRAM_SIZE && mips->instr_memory[i].opcode != EOP; i++){
+		opcode_t opcode = mips->instr_memory[i].opcode;
+		if (opcode != NOP && opcode != ENDLOOP) used[unit_type(opcode)] = true;
+	}
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		if (used[t] && top.units[t] == 0){
+			cout << "ERROR:: the program uses " << dse_unit_names[t] << " units, not in the design space" << endl;
+			exit(-1);
+		}
+	}
+	set<dse_key_t> simulated_here;
+	if (memo.count(point_key(top)) == 0){
+		mips->run();
+		dse_known_t entry = {top, mips->get_IPC()};
+		memo[point_key(top)] = entry.ipc;
+		simulated_here.insert(point_key(top));
+		known.push_back(entry);
+		result.simulated++;
+	}
+	delete mips;
+
+	double best_ipc = -1.0;     //best IPC of the configurations visited so far
+	unsigned cursor = 0;
+	bool done = false;
+	while (cursor < order.size() && !done){
+		// visits the configurations in cost order, as long as their IPC is known or not needed
+		while (cursor < order.size()){
+			const dse_point_t &p = points[order[cursor].second];
+			bool feasible = true;
+			for (unsigned t=0; t<NUM_UNIT_TYPES; t++) feasible = feasible && (!used[t] || p.units[t] > 0);
+			double ipc;
+			if (!feasible){
+				result.infeasible++;
+				cursor++;
+				continue;
+			}
+			map<dse_key_t, double>::iterator it = memo.find(point_key(p));
+			if (it != memo.end()){
+				ipc = it->second;
+				if (simulated_here.count(it->first) == 0) result.memoized++;
+			}else{
+				double low, high;
+				ipc_bounds(p, known, low, high);
+				if (high <= best_ipc){
+					result.pruned++;
+					cursor++;
+					continue;
+				}
+				if (low < high) break;   //to be simulated
+				ipc = high;
+				dse_known_t entry = {p, ipc};
+				known.push_back(entry);
+				result.inferred++;
+			}
+			dse_design_t design = {p, order[cursor].first, ipc};
+			if (!result.pareto.empty() && result.pareto.back().cost == design.cost){
+				if (ipc > result.pareto.back().ipc) result.pareto.back() = design;
+			}else if (ipc > best_ipc){
+				result.pareto.push_back(design);
+			}
+			best_ipc = max(best_ipc, ipc);
+			cursor++;
+			if (config.ipc_target > 0.0 && best_ipc >= config.ipc_target){
+				done = true;
+				break;
+			}
+		}
+		if (cursor == order.size() || done) break;
+
+		// simulates the next configurations that may be on the front, the first of which is needed now
+		vector<dse_point_t> batch;
+		for (unsigned k = cursor; k < order.size() && batch.size() < config.threads; k++){
+			const dse_point_t &p = points[order[k].second];
+			bool feasible = true;
+			for (unsigned t=0; t<NUM_UNIT_TYPES; t++) feasible = feasible && (!used[t] || p.units[t] > 0);
+			if (!feasible || memo.count(point_key(p))) continue;
+			double low, high;
+			ipc_bounds(p, known, low, high);
+			if (high > best_ipc && low < high) batch.push_back(p);
+		}
+		vector<double> ipc;
+		simulate_batch(setup, arg, batch, ipc);
+		for (unsigned i=0; i<batch.size(); i++){
+			memo[point_key(batch[i])] = ipc[i];
+			simulated_here.insert(point_key(batch[i]));
+			dse_known_t entry = {batch[i], ipc[i]};
+			known.push_back(entry);
+		}
+		result.simulated += batch.size();
+	}
+	result.skipped = order.size() - cursor;
+	if (config.ipc_target > 0.0)
+		for (unsigned i=0; i<result.pareto.size() && result.best < 0; i++)
+			if (result.pareto[i].ipc >= config.ipc_target) result.best = i;
+	if (config.cache != NULL) save_cache(config.cache, memo);
+	return result;
+}
+
+void print_design_space_result(const dse_result_t &result){
+	ios::fmtflags flags = cout.flags();
+	streamsize precision = cout.precision();
+	char fill = cout.fill(' ');
+	cout << "Design space: " << dec << result.points << " configurations, " << result.simulated << " simulated, "
+	     << result.memoized << " from the cache, " << result.inferred << " inferred, " << result.pruned << " pruned, "
+	     << result.infeasible << " infeasible, " << result.skipped << " not visited" << endl;
+	cout << "      Cost     IPC  Configuration" << endl;
+	for (unsigned i=0; i<result.pareto.size(); i++){
+		cout << fixed << setprecision(2) << setw(10) << result.pareto[i].cost << setprecision(4) << setw(8) << result.pareto[i].ipc
+		     << "  " << point_text(result.pareto[i].point) << endl;
+	}
+	if (result.ipc_target > 0.0){
+		cout << setprecision(4) << "IPC target " << result.ipc_target << ": ";
+		if (result.best >= 0) cout << point_text(result.pareto[result.best].point) << endl;
+		else cout << "not reached" << endl;
+	}
+	cout.flags(flags);
+	cout.precision(precision);
+	cout.fill(fill);
+}
@@ -0,0 +1,84 @@
+#ifndef SIM_DSE_H_
+#define SIM_DSE_H_
+
+#include <vector>
+#include <string>
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+// design-space exploration over the execution units (instances and latency of each exe_unit_t, as
+// configured by init_exec_unit) and the data memory latency: finds the configurations on the Pareto
+// front of IPC versus a user-supplied area cost, and the cheapest one reaching an IPC target, without
+// simulating the whole grid:
+// - the configurations are visited by increasing cost. Assuming that more units and lower latencies
+//   never lower the IPC, the IPC of a configuration lies between the IPCs of the configurations known
+//   so far that it dominates and that dominate it (the richest configuration is simulated first, so
+//   that every configuration has an upper bound). A configuration whose upper bound does not exceed
+//   the IPC reached by cheaper ones is not on the front and is not simulated; neither is one whose
+//   bounds meet
+// - the configurations still to be simulated are simulated in parallel, "threads" at a time, looking
+//   ahead in cost order
+// - the simulated IPCs are memoized, optionally in a file that successive searches on the same
+//   workload share (e.g. with different costs or targets)
+typedef struct{
+	unsigned units[NUM_UNIT_TYPES];     //instances of each unit type (0: none)
+	unsigned latency[NUM_UNIT_TYPES];   //latency of each unit type (0 if there are no instances)
+	unsigned memory_latency;            //data memory latency
+} dse_point_t;
+
+typedef struct{
+	vector<unsigned> units[NUM_UNIT_TYPES];     //candidate instances of each unit type (empty: none)
+	vector<unsigned> latency[NUM_UNIT_TYPES];   //candidate latencies of each unit type
+	vector<unsigned> memory_latency;            //candidate data memory latencies
+} dse_space_t;
+
+typedef struct{
+	double ipc_target;    //the search stops at the cheapest configuration reaching this IPC (0: whole front)
+	unsigned threads;     //simulations run in parallel
+	const char *cache;    //file memoizing the simulated IPCs across searches (NULL: none)
+} dse_config_t;
+
+// instantiates a simulator with the data memory latency of "point" and its execution units (see
+// init_exec_units), with the program loaded and the data initialized. Invoked from several threads,
+// one at a time
+typedef sim_pipe_fp *(*dse_setup_t)(const dse_point_t &point, void *arg);
+
+// area cost of a configuration
+typedef double (*dse_cost_t)(const dse_point_t &point, void *arg);
+
+typedef struct{
+	dse_point_t point;
+	double cost;
+	double ipc;
+} dse_design_t;
+
+typedef struct{
+	vector<dse_design_t> pareto;  //configurations on the front, by increasing cost (and IPC)
+	double ipc_target;            //IPC target of the search (0: none)
+	int best;                     //front configuration reaching the IPC target (-1 if none or no target)
+	unsigned long long points;    //configurations in the space
+	unsigned simulated;           //configurations simulated
+	unsigned memoized;            //IPCs read from the cache file
+	unsigned inferred;            //IPCs known from their bounds
+	unsigned pruned;              //configurations discarded as not better than cheaper ones
+	unsigned infeasible;          //configurations without a unit type the program uses
+	unsigned skipped;             //configurations not visited (costlier than the one reaching the target)
+} dse_result_t;
+
+// returns the default configuration: whole front, one simulation per hardware thread, no cache file
+dse_config_t dse_defaults();
+
+// adds the execution units of a configuration to a simulator
+void init_exec_units(sim_pipe_fp *mips, const dse_point_t &point);
+
+// returns a configuration as "TYPE instances x latency, ..., memory latency"
+string point_text(const dse_point_t &point);
+
+// explores the space of the program instantiated by "setup"
+dse_result_t explore_design_space(dse_setup_t setup, dse_cost_t cost, void *arg, const dse_space_t &space, const dse_config_t &config);
+
+// prints the front found by explore_design_space and the search effort
+void print_design_space_result(const dse_result_t &result);
+
+#endif /*SIM_DSE_H_*/
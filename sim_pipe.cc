@@ -5,7 +5,12 @@
 #include <cstring>
 #include <string>
 #include <iomanip>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <map>
+#include <vector>
 
 //#define DEBUG
 #define  IS_OPCODE_BRANCH(instr)    (instr.opcode == BLTZ || instr.opcode == BNEZ || \
@@ -21,12 +26,6 @@
 using namespace std;
 
 
-unsigned mInstruction_Count=0;
-unsigned mClock_Cycles=0;
-unsigned mStalls_Count=0;
-unsigned is_memory_ongoing = FALSE;
-unsigned is_branch_ongoing = FALSE;
-unsigned is_branch_calculated = FALSE;
 //used for debugging purposes
 static const char *reg_names[NUM_SP_REGISTERS] = {"PC", "NPC", "IR", "A", "B", "IMM", "COND", "ALU_OUTPUT", "LMD"};
 static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
@@ -56,6 +55,80 @@ inline unsigned char2int(unsigned char *buffer){
 	return d;
 }
 
+/* =============   digest of the machine state ============== */
+
+/* digest of an aligned memory word; a word with all bytes at 0xFF (as after reset) contributes nothing,
+   so that the digest of the whole memory can be maintained with a xor per write */
+static inline unsigned long long word_digest(unsigned address, unsigned value){
+	if (value == UNDEFINED) return 0;
+	unsigned long long x = ((unsigned long long)address << 32) | value;
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/* digest of the aligned words overlapping [address, address+4) */
+static unsigned long long words_digest(unsigned char *memory, unsigned size, unsigned address){
+	unsigned long long digest = 0;
+	for (unsigned a = address & ~3u; a < address + 4; a += 4)
+		if (a + 4 <= size) digest ^= word_digest(a, char2int(memory + a));
+	return digest;
+}
+
+/* digest of the aligned words overlapping [start_address, end_address) */
+static unsigned long long range_digest(unsigned char *memory, unsigned size, unsigned start_address, unsigned end_address){
+	unsigned long long digest = 0;
+	for (unsigned a = start_address & ~3u; a < end_address && a + 4 <= size; a += 4) digest ^= word_digest(a, char2int(memory + a));
+	return digest;
+}
+
+static inline void digest_word(unsigned long long &digest, unsigned value){
+	digest = (digest ^ value) * 0x100000001b3ULL;
+}
+
+/* =============   buffered formatting of the dumps ============== */
+
+/* the dumps are formatted by hand into a buffer and written with a single call: going through the
+   iostream manipulators for every byte dominates the run time when the state is dumped at every cycle */
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/* writes "value" in hexadecimal with exactly "digits" digits; returns the end of the output */
+static inline char *put_hex(char *p, unsigned value, unsigned digits){
+	for (unsigned d=digits; d>0; d--, value >>= 4) p[d-1] = hex_digits[value & 0xf];
+	return p + digits;
+}
+
+/* writes "value" in hexadecimal, without leading zeros */
+static inline char *put_hex(char *p, unsigned value){
+	unsigned digits = 1;
+	while (digits < 8 && (value >> (4*digits)) != 0) digits++;
+	return put_hex(p, value, digits);
+}
+
+static inline char *put_dec(char *p, unsigned value){
+	char digits[10];
+	unsigned n = 0;
+	do{
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	}while (value != 0);
+	while (n > 0) *p++ = digits[--n];
+	return p;
+}
+
+static inline char *put_dec(char *p, int value){
+	if (value >= 0) return put_dec(p, (unsigned)value);
+	*p++ = '-';
+	return put_dec(p, 0u - (unsigned)value);
+}
+
+static inline char *put_str(char *p, const char *s){
+	while (*s) *p++ = *s++;
+	return p;
+}
+
 /* implements the ALU operations */
 unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc){
 	switch(opcode){
@@ -91,6 +164,65 @@ unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc
 
    ============================================================= */
 
+/* a segment of initialized data declared in an assembly file */
+typedef struct{
+	unsigned address;
+	vector<unsigned char> bytes;
+} data_segment_t;
+
+/* parses a data directive, whose operands are read with strtok:
+   .data [address]   starts a segment at address (by default, where the previous segment ended)
+   .word v1 v2 ...   32-bit integers
+   .float v1 v2 ...  single precision values
+   .space n          n bytes at 0
+   .text             returns to the instructions (accepted for readability only) */
+static void parse_data_directive(const char *filename, const char *directive, vector<data_segment_t> &segments){
+	char *operand, *end;
+	if (!strcmp(directive, ".text")) return;
+	if (!strcmp(directive, ".data")){
+		data_segment_t segment;
+		operand = strtok(NULL, " \t\r");
+		if (operand != NULL){
+			segment.address = strtoul(operand, &end, 0);
+			if (*end != '\0'){
+				cout << "ERROR:: invalid address " << operand << " for .data in " << filename << endl;
+				exit(-1);
+			}
+		}else if (!segments.empty()){
+			segment.address = segments.back().address + segments.back().bytes.size();
+		}else{
+			cout << "ERROR:: the first .data in " << filename << " must specify an address" << endl;
+			exit(-1);
+		}
+		segments.push_back(segment);
+		return;
+	}
+	bool is_word = !strcmp(directive, ".word");
+	bool is_float = !strcmp(directive, ".float");
+	if (!is_word && !is_float && strcmp(directive, ".space")){
+		cout << "ERROR:: unknown directive " << directive << " in " << filename << endl;
+		exit(-1);
+	}
+	if (segments.empty()){
+		cout << "ERROR:: " << directive << " outside of a .data segment in " << filename << endl;
+		exit(-1);
+	}
+	vector<unsigned char> &bytes = segments.back().bytes;
+	while ((operand = strtok(NULL, " \t\r,")) != NULL){
+		unsigned value;
+		if (is_float){
+			float f = strtof(operand, &end);
+			memcpy(&value, &f, sizeof value);
+		}else value = (unsigned)strtoll(operand, &end, 0);
+		if (*end != '\0'){
+			cout << "ERROR:: invalid operand " << operand << " for " << directive << " in " << filename << endl;
+			exit(-1);
+		}
+		if (is_word || is_float) for (unsigned b=0; b<4; b++) bytes.push_back(value >> (8*b));
+		else bytes.insert(bytes.end(), value, 0);
+	}
+}
+
 /* loads the assembly program in file "filename" in instruction memory at the specified address */
 void sim_pipe::load_program(const char *filename, unsigned base_address){
 
@@ -113,12 +245,22 @@ void sim_pipe::load_program(const char *filename, unsigned base_address){
    /* parsing the assembly file line by line */
    string line;
    unsigned instruction_nr = 0;
+   vector<data_segment_t> segments;
    while (getline(fin,line)){
+	if (instruction_nr >= PROGRAM_SIZE){
+		cout << "ERROR:: program " << filename << " larger than " << PROGRAM_SIZE << " instructions" << endl;
+		exit(-1);
+	}
 	// set the instruction field
 	char *str = const_cast<char*>(line.c_str());
 
   	// tokenize the instruction
 	char *token = strtok (str," \t");
+	if (token == NULL) continue;
+	if (token[0] == '.'){
+		parse_data_directive(filename, token, segments);
+		continue;
+	}
 	map<string, opcode_t>::iterator search = opcodes.find(token);
         if (search == opcodes.end()){
 		// this is a label for a branch - extract it and save it in the labels map
@@ -191,6 +333,9 @@ void sim_pipe::load_program(const char *filename, unsigned base_address){
 	/* increment instruction number before moving to next line */
 	instruction_nr++;
    }
+   //copying the data segments into the data memory, one block per segment
+   for (unsigned s=0; s<segments.size(); s++)
+	if (!segments[s].bytes.empty()) write_memory_block(segments[s].address, &segments[s].bytes[0], segments[s].bytes.size());
    //reconstructing the labels of the branch operations
    int i = 0;
    while(true){
@@ -211,45 +356,217 @@ void sim_pipe::load_program(const char *filename, unsigned base_address){
 
 /* writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness) */
 void sim_pipe::write_memory(unsigned address, unsigned value){
+	if (memory_digest_valid) memory_digest ^= words_digest(data_memory, data_memory_size, address);
 	int2char(value,data_memory+address);
+	if (memory_digest_valid) memory_digest ^= words_digest(data_memory, data_memory_size, address);
+}
+
+/* copies a block of bytes into the data memory at the specified address */
+void sim_pipe::write_memory_block(unsigned address, const unsigned char *bytes, unsigned size){
+	if (address > data_memory_size || size > data_memory_size - address){
+		cout << "ERROR:: block of " << dec << size << " bytes at 0x" << hex << address << " does not fit in the data memory" << endl;
+		exit(-1);
+	}
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, address, address + size);
+	memcpy(data_memory + address, bytes, size);
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, address, address + size);
+}
+
+unsigned long long sim_pipe::memory_hash(){
+	if (!memory_digest_valid){
+		memory_digest = range_digest(data_memory, data_memory_size, 0, data_memory_size);
+		memory_digest_valid = true;
+	}
+	return memory_digest;
+}
+
+unsigned long long sim_pipe::state_hash(){
+	unsigned long long digest = memory_hash() ^ 0xcbf29ce484222325ULL;
+	for (unsigned s=0; s<NUM_STAGES; s++)
+		for (unsigned r=0; r<NUM_SP_REGISTERS; r++) digest_word(digest, get_sp_register((sp_register_t)r, (stage_t)s));
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) digest_word(digest, get_gp_register(r));
+	return digest;
 }
 
 /* prints the content of the data memory within the specified address range */
 void sim_pipe::print_memory(unsigned start_address, unsigned end_address){
-	cout << "data_memory[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
+	unsigned size = (end_address > start_address) ? end_address - start_address : 0;
+	string buffer(32 + size * 3 + (size / 4 + 2) * 13, '\0');
+	char *begin = &buffer[0], *p = begin;
+	p = put_str(p, "data_memory[0x");
+	p = put_hex(p, start_address, 8);
+	p = put_str(p, ":0x");
+	p = put_hex(p, end_address, 8);
+	p = put_str(p, "]\n");
 	for (unsigned i=start_address; i<end_address; i++){
-		if (i%4 == 0) cout << "0x" << hex << setw(8) << setfill('0') << i << ": "; 
-		cout << hex << setw(2) << setfill('0') << int(data_memory[i]) << " ";
-		if (i%4 == 3) cout << endl;
-	} 
+		if (i%4 == 0){
+			p = put_str(p, "0x");
+			p = put_hex(p, i, 8);
+			p = put_str(p, ": ");
+		}
+		p = put_hex(p, data_memory[i], 2);
+		*p++ = ' ';
+		if (i%4 == 3) *p++ = '\n';
+	}
+	cout.write(begin, p - begin);
+	cout << hex << setfill('0');	//stream state left as by the previous iostream version
+}
+
+/* =============   data memory backing ============== */
+
+/* the data memory is an anonymous mapping, so that data images can be mapped over parts of it */
+static unsigned char *map_anonymous_memory(unsigned char *address, size_t size){
+	void *memory = mmap(address, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (address != NULL ? MAP_FIXED : 0), -1, 0);
+	if (memory == MAP_FAILED){
+		cout << "ERROR:: cannot allocate a data memory of " << dec << size << " bytes" << endl;
+		exit(-1);
+	}
+	return (unsigned char *)memory;
+}
+
+static size_t round_to_page(size_t size){
+	size_t page = sysconf(_SC_PAGESIZE);
+	return (size == 0) ? page : (size + page - 1) / page * page;
+}
+
+/* checks that an image of "size" bytes fits in the data memory at base_address */
+static void check_image_range(const char *filename, unsigned base_address, size_t size, unsigned memory_size){
+	if (base_address > memory_size || size > memory_size - base_address){
+		cout << "ERROR:: data image " << filename << " (" << dec << size << " bytes) does not fit in the data memory at 0x" << hex << base_address << endl;
+		exit(-1);
+	}
+}
+
+/* writes the data memory within the specified address range, as raw bytes, to the given file */
+void sim_pipe::dump_memory(const char *filename, unsigned start_address, unsigned end_address){
+	if (end_address < start_address || end_address > data_memory_size){
+		cout << "ERROR:: invalid memory range [0x" << hex << start_address << ":0x" << end_address << "] for dump" << endl;
+		exit(-1);
+	}
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open memory dump file " << filename << endl;
+		exit(-1);
+	}
+	if (fwrite(data_memory + start_address, 1, end_address - start_address, file) != end_address - start_address){
+		cout << "ERROR:: cannot write memory dump file " << filename << endl;
+		exit(-1);
+	}
+	fclose(file);
+}
+
+/* copies a raw data image into the data memory at the given address */
+void sim_pipe::load_data_image(const char *filename, unsigned base_address){
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open data image " << filename << endl;
+		exit(-1);
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	check_image_range(filename, base_address, size, data_memory_size);
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, base_address, base_address + size);
+	if (fread(data_memory + base_address, 1, size, file) != (size_t)size){
+		cout << "ERROR:: cannot read data image " << filename << endl;
+		exit(-1);
+	}
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, base_address, base_address + size);
+	fclose(file);
+}
+
+/* writes the whole data memory as a raw data image */
+void sim_pipe::dump_data_image(const char *filename){
+	dump_memory(filename, 0, data_memory_size);
+}
+
+/* maps a raw data image into the data memory at the given address */
+void sim_pipe::map_data_image(const char *filename, unsigned base_address, bool shared){
+	if (base_address % sysconf(_SC_PAGESIZE) != 0){
+		cout << "ERROR:: data image " << filename << " must be mapped at a multiple of the page size (0x" << hex << base_address << ")" << endl;
+		exit(-1);
+	}
+	int fd = open(filename, shared ? O_RDWR : O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0){
+		cout << "ERROR:: cannot open data image " << filename << endl;
+		exit(-1);
+	}
+	check_image_range(filename, base_address, info.st_size, data_memory_size);
+	if (info.st_size > 0 && mmap(data_memory + base_address, info.st_size, PROT_READ | PROT_WRITE,
+	                             (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_FIXED, fd, 0) == MAP_FAILED){
+		cout << "ERROR:: cannot map data image " << filename << endl;
+		exit(-1);
+	}
+	close(fd);
+	memory_digest_valid = false;
+}
+
+/* formats one register line: "<name> = <decimal> / 0x<hex>" */
+static inline char *put_register(char *p, const char *name, unsigned index, int value, bool is_signed){
+	p = put_str(p, name);
+	if (index != UNDEFINED) p = put_dec(p, index);
+	p = put_str(p, " = ");
+	p = is_signed ? put_dec(p, value) : put_dec(p, (unsigned)value);
+	p = put_str(p, " / 0x");
+	p = put_hex(p, (unsigned)value);
+	*p++ = '\n';
+	return p;
 }
 
 /* prints the values of the registers */
 void sim_pipe::print_registers(){
-        cout << "Special purpose registers:" << endl;
-        unsigned i, s;
-        for (s=0; s<NUM_STAGES; s++){
-                cout << "Stage: " << stage_names[s] << endl;
-                for (i=0; i< NUM_SP_REGISTERS; i++)
-                        if ((sp_register_t)i != IR && (sp_register_t)i != COND && get_sp_register((sp_register_t)i, (stage_t)s)!=UNDEFINED) cout << reg_names[i] << " = " << dec <<  get_sp_register((sp_register_t)i, (stage_t)s) << hex << " / 0x" << get_sp_register((sp_register_t)i, (stage_t)s) << endl;
-        }
-        cout << "General purpose registers:" << endl;
-        for (i=0; i< NUM_GP_REGISTERS; i++)
-                if (get_gp_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << get_gp_register(i) << hex << " / 0x" << get_gp_register(i) << endl;
+	char buffer[32 + NUM_STAGES * (16 + NUM_SP_REGISTERS * 48) + NUM_GP_REGISTERS * 48];
+	char *p = buffer;
+	bool printed = false;
+	unsigned i, s;
+	p = put_str(p, "Special purpose registers:\n");
+	for (s=0; s<NUM_STAGES; s++){
+		p = put_str(p, "Stage: ");
+		p = put_str(p, stage_names[s]);
+		*p++ = '\n';
+		for (i=0; i< NUM_SP_REGISTERS; i++){
+			if ((sp_register_t)i == IR || (sp_register_t)i == COND) continue;
+			unsigned value = get_sp_register((sp_register_t)i, (stage_t)s);
+			if (value == UNDEFINED) continue;
+			p = put_register(p, reg_names[i], UNDEFINED, value, false);
+			printed = true;
+		}
+	}
+	p = put_str(p, "General purpose registers:\n");
+	for (i=0; i< NUM_GP_REGISTERS; i++){
+		int value = get_gp_register(i);
+		if (value == (int)UNDEFINED) continue;
+		p = put_register(p, "R", i, value, true);
+		printed = true;
+	}
+	cout.write(buffer, p - buffer);
+	if (printed) cout << hex;	//stream state left as by the previous iostream version
 }
 
 /* initializes the pipeline simulator */
 sim_pipe::sim_pipe(unsigned mem_size, unsigned mem_latency){
 	data_memory_size = mem_size;
 	data_memory_latency = mem_latency;
-	data_memory = new unsigned char[data_memory_size];
+	data_memory_mapping_size = round_to_page(data_memory_size);
+	data_memory = map_anonymous_memory(NULL, data_memory_mapping_size);
     memset(data_memory,0xFF,data_memory_size*sizeof(unsigned char));
+	memory_digest = 0;
+	memory_digest_valid = true;
+	mInstruction_Count = 0;
+	mClock_Cycles = 0;
+	mStalls_Count = 0;
+	is_memory_ongoing = FALSE;
+	is_branch_ongoing = FALSE;
+	is_branch_calculated = FALSE;
+	mControlDelay = 0;
+	mMemDelay = 0;
 	reset();
 }
 	
 /* deallocates the pipeline simulator */
 sim_pipe::~sim_pipe(){
-	delete [] data_memory;
+	munmap(data_memory, data_memory_mapping_size);
 }
 
 /* =============================================================
@@ -309,6 +626,8 @@ void sim_pipe::run(unsigned cycles)
 /* reset the state of the pipeline simulator */
 void sim_pipe::reset(){
     
+	// init instruction memory (the operands an instruction does not use are read as register 0 by the hazard checks)
+	for (int i=0; i<PROGRAM_SIZE;i++) instr_memory[i] = instruction_t();
     /** Added Code Start **/
     /** Reset register file **/
     sim_pipe_reg_file[0].regVal = 0;
@@ -322,6 +641,7 @@ void sim_pipe::reset(){
     {
         sim_pipe_pipeline_reg[i].PC = UNDEFINED;
         sim_pipe_pipeline_reg[i].NPC = UNDEFINED;
+        sim_pipe_pipeline_reg[i].IR = instruction_t();
         sim_pipe_pipeline_reg[i].IR.opcode = NOP;
         sim_pipe_pipeline_reg[i].Rd = UNDEFINED;
         sim_pipe_pipeline_reg[i].Imm = UNDEFINED;
@@ -474,10 +794,9 @@ void pipe_ID_Handler(sim_pipe* mSimPipe)
     unsigned SW_Swap;
     unsigned tempSrc1;
     unsigned tempSrc2;
-    static unsigned mControlDelay=0;
 
     /*Check any RAW hazards if not NOP and EOP instruction*/
-    if((is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode != EOP) && (mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode != NOP))
+    if((mSimPipe->is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode != EOP) && (mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode != NOP))
     {
         tempSrc1 = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src1;
         tempSrc2 = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src2;
@@ -485,7 +804,7 @@ void pipe_ID_Handler(sim_pipe* mSimPipe)
             if ((mSimPipe->sim_pipe_reg_file[tempSrc1].isDestination == TRUE) ||
                 (mSimPipe->sim_pipe_reg_file[tempSrc2].isDestination == TRUE)) {
                 /*RAW - issue stall*/
-                mStalls_Count++;
+                mSimPipe->mStalls_Count++;
                 mSimPipe->sim_pipe_pipeline_reg[EXE].IR.opcode = NOP;
                 mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                 mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
@@ -494,25 +813,25 @@ void pipe_ID_Handler(sim_pipe* mSimPipe)
                 mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = TRUE;
                 if(IS_OPCODE_BRANCH(mSimPipe->sim_pipe_pipeline_reg[ID].IR))
                 {
-                    mControlDelay++;
-                    if(mControlDelay==1)
+                    mSimPipe->mControlDelay++;
+                    if(mSimPipe->mControlDelay==1)
                     {
-                        mStalls_Count++;
+                        mSimPipe->mStalls_Count++;
                         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
-                        is_branch_ongoing = TRUE;
-                        is_branch_calculated = FALSE;
+                        mSimPipe->is_branch_ongoing = TRUE;
+                        mSimPipe->is_branch_calculated = FALSE;
 
-                    }else if(is_branch_calculated == TRUE)//(mSimPipe->sim_pipe_pipeline_reg[EXE].isAvailable == FALSE)
+                    }else if(mSimPipe->is_branch_calculated == TRUE)//(mSimPipe->sim_pipe_pipeline_reg[EXE].isAvailable == FALSE)
                     {
-                        mControlDelay = 0;
-                        //mStalls_Count++;
+                        mSimPipe->mControlDelay = 0;
+                        //mSimPipe->mStalls_Count++;
                         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = TRUE;
-                        is_branch_ongoing = FALSE;
-                        is_branch_calculated = FALSE;
+                        mSimPipe->is_branch_ongoing = FALSE;
+                        mSimPipe->is_branch_calculated = FALSE;
                     }else
                     {
-                        mStalls_Count++;
+                        mSimPipe->mStalls_Count++;
                         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
                     }
@@ -659,34 +978,33 @@ void pipe_EXE_Handler(sim_pipe* mSimPipe)
 
 void pipe_MEM_Handler(sim_pipe* mSimPipe)
 {
-    static unsigned mMemDelay = 0;
 
-    if(IS_OPCODE_BRANCH(mSimPipe->sim_pipe_pipeline_reg[MEM].IR) && (is_branch_ongoing == TRUE))
+    if(IS_OPCODE_BRANCH(mSimPipe->sim_pipe_pipeline_reg[MEM].IR) && (mSimPipe->is_branch_ongoing == TRUE))
     {
-        is_branch_calculated = TRUE;
+        mSimPipe->is_branch_calculated = TRUE;
     }
-    if((IS_OPCODE_MEM(mSimPipe->sim_pipe_pipeline_reg[MEM].IR)) && (is_memory_ongoing == FALSE))
+    if((IS_OPCODE_MEM(mSimPipe->sim_pipe_pipeline_reg[MEM].IR)) && (mSimPipe->is_memory_ongoing == FALSE))
     {
-        mMemDelay = mSimPipe->data_memory_latency + 1;
-        is_memory_ongoing = TRUE;
+        mSimPipe->mMemDelay = mSimPipe->data_memory_latency + 1;
+        mSimPipe->is_memory_ongoing = TRUE;
         mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = FALSE;
         mSimPipe->sim_pipe_pipeline_reg[EXE].isAvailable = FALSE;
         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
     }
-    if(is_memory_ongoing == TRUE)
+    if(mSimPipe->is_memory_ongoing == TRUE)
     {
-        if(mMemDelay <= 1)
+        if(mSimPipe->mMemDelay <= 1)
         {
-            is_memory_ongoing = FALSE;
+            mSimPipe->is_memory_ongoing = FALSE;
             mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = TRUE;
             mSimPipe->sim_pipe_pipeline_reg[EXE].isAvailable = TRUE;
             mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = TRUE;
             mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = TRUE;
         }else
         {
-            mStalls_Count++;
-            mMemDelay--;
+            mSimPipe->mStalls_Count++;
+            mSimPipe->mMemDelay--;
         }
     }
     if(mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == TRUE)
@@ -771,7 +1089,7 @@ void pipe_WB_Handler(sim_pipe* mSimPipe)
     }
     if((mSimPipe->sim_pipe_pipeline_reg[WB].isAvailable == TRUE) && (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode != NOP) && (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode != EOP))
     {
-        mInstruction_Count++;
+        mSimPipe->mInstruction_Count++;
         if (tempRd < REGISTER_FILE_SIZE)
         {
             if ((IS_OPCODE_ALU(mSimPipe->sim_pipe_pipeline_reg[WB].IR)) ||
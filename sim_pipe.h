@@ -6,7 +6,7 @@
 
 using namespace std;
 
-#define PROGRAM_SIZE 50
+#define PROGRAM_SIZE 1024
 
 #define UNDEFINED 0xFFFFFFFF //used to initialize the registers
 #define NUM_SP_REGISTERS 9
@@ -65,6 +65,16 @@ public:
     /** Added Code Start**/
     regFileElement_t sim_pipe_reg_file[REGISTER_FILE_SIZE];
     pipelineRegVals_t sim_pipe_pipeline_reg[NUM_STAGES];
+
+    //counters and pipeline control state, per instance so that several simulators can run concurrently
+    unsigned mInstruction_Count;
+    unsigned mClock_Cycles;
+    unsigned mStalls_Count;
+    unsigned is_memory_ongoing;
+    unsigned is_branch_ongoing;
+    unsigned is_branch_calculated;
+    unsigned mControlDelay;   //cycles the branch in ID has been waiting
+    unsigned mMemDelay;       //cycles left for the memory access in MEM
     /** Added Code End**/
         //instruction memory 
         instruction_t instr_memory[PROGRAM_SIZE];
@@ -81,6 +91,15 @@ public:
 	//memory latency in clock cycles
 	unsigned data_memory_latency;
 
+	//digest of the data memory, maintained by write_memory (0 for a memory with all bytes at 0xFF)
+	unsigned long long memory_digest;
+
+	//false after a data image has been mapped: the digest is then recomputed by the next memory_hash()
+	bool memory_digest_valid;
+
+	//size of the anonymous mapping backing the data memory (the memory size rounded up to a page)
+	size_t data_memory_mapping_size;
+
 
 
 	//instantiates the simulator with a data memory of given size (in bytes) and latency (in clock cycles)
@@ -142,9 +161,34 @@ public:
 	//prints the content of the data memory within the specified address range
 	void print_memory(unsigned start_address, unsigned end_address);
 
+	//writes the data memory within the specified address range to "filename" as raw bytes
+	//(faster and more compact than print_memory for large ranges)
+	void dump_memory(const char *filename, unsigned start_address, unsigned end_address);
+
+	//copies "filename", a raw little-endian image (e.g. written by dump_data_image), into the data memory at base_address
+	void load_data_image(const char *filename, unsigned base_address);
+
+	//writes the whole data memory to "filename" as a raw image
+	void dump_data_image(const char *filename);
+
+	//maps "filename" into the data memory at base_address (a multiple of the page size) instead of copying it,
+	//so that the pages are only read when accessed; with shared=true the stores go through to the file,
+	//otherwise they stay private to the simulator (copy-on-write). The rest of the last page of the file reads as 0
+	void map_data_image(const char *filename, unsigned base_address, bool shared=false);
+
 	// writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness)
 	void write_memory(unsigned address, unsigned value);
 
+	//copies "size" bytes into the data memory at the specified address (e.g. the data segments of a program)
+	void write_memory_block(unsigned address, const unsigned char *bytes, unsigned size);
+
+	//returns a 64-bit digest of the machine state: register files, pipeline registers and data memory
+	//(the data memory part is maintained incrementally, so the cost does not depend on the memory size)
+	unsigned long long state_hash();
+
+	//returns the digest of the data memory only
+	unsigned long long memory_hash();
+
 	//prints the values of the registers 
 	void print_registers();
 
@@ -1,11 +1,22 @@
 #include "sim_pipe_fp.h"
+#include "sim_trace.h"
+#include "sim_reuse.h"
+#include "sim_dataflow.h"
 #include <stdlib.h>
 #include <iostream>
 #include <fstream>
 #include <cstring>
 #include <string>
 #include <iomanip>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <map>
+#include <cmath>
+#include <vector>
+#include <sstream>
+#include <algorithm>
 
 //NOTE: structural hazards on MEM/WB stage not handled
 //====================================================
@@ -22,18 +33,12 @@
 
 using namespace std;
 
-unsigned mInstruction_Count=0;
-unsigned mClock_Cycles=0;
-unsigned mStalls_Count=0;
-unsigned is_memory_ongoing = FALSE;
-unsigned is_branch_ongoing = FALSE;
-unsigned is_branch_calculated = FALSE;
 
 //used for debugging purposes
 static const char *reg_names[NUM_SP_REGISTERS] = {"PC", "NPC", "IR", "A", "B", "IMM", "COND", "ALU_OUTPUT", "LMD"};
 static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
-static const char *instr_names[NUM_OPCODES] = {"LW", "SW", "ADD", "ADDI", "SUB", "SUBI", "XOR", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS"};
-static const char *unit_names[4]={"INTEGER", "ADDER", "MULTIPLIER", "DIVIDER"};
+static const char *instr_names[NUM_OPCODES] = {"LW", "SW", "ADD", "ADDI", "SUB", "SUBI", "XOR", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS", "LOOP", "ENDLOOP", "LV", "SV", "LVWS", "SVWS", "ADDV", "SUBV", "MULV", "FMADDS"};
+static const char *unit_names[NUM_UNIT_TYPES]={"INTEGER", "ADDER", "MULTIPLIER", "DIVIDER", "VECTOR_ADDER", "VECTOR_MULTIPLIER", "VECTOR_MEMORY", "FMA"};
 
 /* =============================================================
 
@@ -48,6 +53,15 @@ void pipe_MEM_Handler(sim_pipe_fp* mSimPipe);
 void pipe_WB_Handler(sim_pipe_fp* mSimPipe);
 unsigned alu_compute_cond(opcode_t mOpCode, int mSrc);
 unsigned isOpCodeFpType(opcode_t mOpCode);
+void vector_hazard_check(sim_pipe_fp* mSimPipe, unsigned *isRAWPresent, unsigned *isWAWPresent, unsigned *chainMask);
+unsigned vector_chain_pending(sim_pipe_fp* mSimPipe, unsigned unit);
+void rename_sources(sim_pipe_fp* mSimPipe, instruction_t *mInstr);
+renameTable_t *rename_dest_table(sim_pipe_fp* mSimPipe, opcode_t mOpCode);
+void rename_release_registers(sim_pipe_fp* mSimPipe, renameTable_t *mTable, regFileElement_t *mRegFile);
+void record_stall(sim_pipe_fp* mSimPipe, stall_cause_t mCause);
+stall_cause_t structural_stall_cause(sim_pipe_fp* mSimPipe, opcode_t mOpCode);
+void record_retire(sim_pipe_fp* mSimPipe, instruction_t &mInstr);
+void profile_memory_access(sim_pipe_fp* mSimPipe, opcode_t mOpCode, unsigned mPC, unsigned mAddress);
 
 /* convert a float into an unsigned */
 inline unsigned float2unsigned(float value){
@@ -82,8 +96,24 @@ bool is_branch(opcode_t opcode){
 	return (opcode == BEQZ || opcode == BNEZ || opcode == BLTZ || opcode == BLEZ || opcode == BGTZ || opcode == BGEZ || opcode == JUMP);
 }
 
+bool is_vector_memory(opcode_t opcode){
+        return (opcode == LV || opcode == SV || opcode == LVWS || opcode == SVWS);
+}
+
+bool is_vector_store(opcode_t opcode){
+        return (opcode == SV || opcode == SVWS);
+}
+
+bool is_vector_alu(opcode_t opcode){
+        return (opcode == ADDV || opcode == SUBV || opcode == MULV);
+}
+
+bool is_vector(opcode_t opcode){
+        return (is_vector_memory(opcode) || is_vector_alu(opcode));
+}
+
 bool is_memory(opcode_t opcode){
-        return (opcode == LW || opcode == SW || opcode == LWS || opcode == SWS);
+        return (opcode == LW || opcode == SW || opcode == LWS || opcode == SWS || is_vector_memory(opcode));
 }
 
 bool is_int_r(opcode_t opcode){
@@ -99,11 +129,61 @@ bool is_int_alu(opcode_t opcode){
 }
 
 bool is_fp_alu(opcode_t opcode){
-        return (opcode == ADDS || opcode == SUBS || opcode == MULTS || opcode == DIVS);
+        return (opcode == ADDS || opcode == SUBS || opcode == MULTS || opcode == DIVS || opcode == FMADDS);
+}
+
+/* register file ('R', 'F' or 'V') read through source field 1, 2 or 3 of an instruction, 0 if none */
+char operand_class(opcode_t opcode, unsigned field){
+        switch(field){
+                case 1:
+                        if (opcode == SWS || is_fp_alu(opcode)) return 'F';
+                        if (opcode == SV || opcode == SVWS || is_vector_alu(opcode)) return 'V';
+                        if (is_int_alu(opcode) || is_memory(opcode) || is_branch(opcode) || opcode == LOOP) return (opcode == JUMP) ? 0 : 'R';
+                        return 0;
+                case 2:
+                        if (is_int_r(opcode) || opcode == SW || opcode == SWS || opcode == SV || opcode == SVWS) return 'R';
+                        if (is_fp_alu(opcode)) return 'F';
+                        if (is_vector_alu(opcode)) return 'V';
+                        return 0;
+                case 3:
+                        if (opcode == FMADDS) return 'F';
+                        if (is_vector_memory(opcode)) return 'R';
+                        return 0;
+                default:
+                        return 0;
+        }
+}
+
+/* returns the assembly text of an instruction, in the syntax accepted by load_program */
+string instruction_text(const instruction_t &instr){
+        stringstream ss;
+        char dest = (is_fp_alu(instr.opcode) || instr.opcode == LWS) ? 'F' : ((instr.opcode == LV || instr.opcode == LVWS || is_vector_alu(instr.opcode)) ? 'V' : 'R');
+        ss << instr_names[instr.opcode];
+        if (is_memory(instr.opcode)){
+                bool store = (instr.opcode == SW || instr.opcode == SWS || is_vector_store(instr.opcode));
+                unsigned base = store ? instr.src2 : instr.src1;
+                if (store) ss << " " << operand_class(instr.opcode, 1) << instr.src1;
+                else ss << " " << dest << instr.dest;
+                ss << " " << (int)instr.immediate << "(R" << base << ")";
+                if (instr.src3 != UNDEFINED) ss << " R" << instr.src3;
+        }else if (is_branch(instr.opcode)){
+                if (instr.opcode != JUMP) ss << " R" << instr.src1;
+                ss << " " << instr.label;
+        }else if (instr.opcode == LOOP){
+                ss << " R" << instr.src1;
+        }else if (instr.dest != UNDEFINED){
+                ss << " " << dest << instr.dest;
+                for (unsigned f=1; f<=3; f++){
+                        unsigned reg = (f == 1) ? instr.src1 : ((f == 2) ? instr.src2 : instr.src3);
+                        if (operand_class(instr.opcode, f) != 0 && reg != UNDEFINED) ss << " " << operand_class(instr.opcode, f) << reg;
+                }
+                if (is_int_imm(instr.opcode)) ss << " " << (int)instr.immediate;
+        }
+        return ss.str();
 }
 
 /* implements the ALU operations */
-unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc){
+unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc, unsigned c=UNDEFINED){
 	switch(opcode){
 			case ADD:
 				return (a+b);
@@ -119,6 +199,10 @@ unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc
 			case SW:
 			case LWS:
 			case SWS:
+			case LV:
+			case SV:
+			case LVWS:
+			case SVWS:
 				return(a + imm);
 			case BEQZ:
 			case BNEZ:
@@ -140,6 +224,9 @@ unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc
 			case DIVS:
 				return(float2unsigned(unsigned2float(a)/unsigned2float(b)));
 				break;
+			case FMADDS:
+				return(float2unsigned(fmaf(unsigned2float(a), unsigned2float(b), unsigned2float(c))));
+				break;
 			default:
 				return (-1);
 	}
@@ -153,53 +240,345 @@ unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc
 
 /* ============== primitives to allocate/free the simulator ================== */
 
+/* the data memory is an anonymous mapping, so that data images can be mapped over parts of it */
+static unsigned char *map_anonymous_memory(unsigned char *address, size_t size){
+	void *memory = mmap(address, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (address != NULL ? MAP_FIXED : 0), -1, 0);
+	if (memory == MAP_FAILED){
+		cout << "ERROR:: cannot allocate a data memory of " << dec << size << " bytes" << endl;
+		exit(-1);
+	}
+	return (unsigned char *)memory;
+}
+
+static size_t round_to_page(size_t size){
+	size_t page = sysconf(_SC_PAGESIZE);
+	return (size == 0) ? page : (size + page - 1) / page * page;
+}
+
+/* checks that an image of "size" bytes fits in the data memory at base_address */
+static void check_image_range(const char *filename, unsigned base_address, size_t size, unsigned memory_size){
+	if (base_address > memory_size || size > memory_size - base_address){
+		cout << "ERROR:: data image " << filename << " (" << dec << size << " bytes) does not fit in the data memory at 0x" << hex << base_address << endl;
+		exit(-1);
+	}
+}
+
 sim_pipe_fp::sim_pipe_fp(unsigned mem_size, unsigned mem_latency){
 	data_memory_size = mem_size;
 	data_memory_latency = mem_latency;
-	data_memory = new unsigned char[data_memory_size];
+	data_memory_mapping_size = round_to_page(data_memory_size);
+	data_memory = map_anonymous_memory(NULL, data_memory_mapping_size);
+	data_image_mapped = false;
 	num_units = 0;
+	pipeline_trace = NULL;
+	trace_recorder = NULL;
+	trace_replay = NULL;
+	reuse_analysis = NULL;
+	dataflow_analysis = NULL;
 	reset();
 }
 
 sim_pipe_fp::~sim_pipe_fp(){
-	delete [] data_memory;
+	disable_pipeline_trace();
+	disable_reuse_analysis();
+	if (dataflow_analysis != NULL) delete dataflow_analysis;
+	if (trace_replay != NULL) delete trace_replay;
+	munmap(data_memory, data_memory_mapping_size);
 }
 
 /* =============   primitives to print out the content of the memory & registers and for writing to memory ============== */
 
+/* the dumps are formatted by hand into a buffer and written with a single call: going through the
+   iostream manipulators for every byte dominates the run time when the state is dumped at every cycle */
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/* writes "value" in hexadecimal with exactly "digits" digits; returns the end of the output */
+static inline char *put_hex(char *p, unsigned value, unsigned digits){
+	for (unsigned d=digits; d>0; d--, value >>= 4) p[d-1] = hex_digits[value & 0xf];
+	return p + digits;
+}
+
+/* writes "value" in hexadecimal, without leading zeros */
+static inline char *put_hex(char *p, unsigned value){
+	unsigned digits = 1;
+	while (digits < 8 && (value >> (4*digits)) != 0) digits++;
+	return put_hex(p, value, digits);
+}
+
+static inline char *put_dec(char *p, unsigned value){
+	char digits[10];
+	unsigned n = 0;
+	do{
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	}while (value != 0);
+	while (n > 0) *p++ = digits[--n];
+	return p;
+}
+
+static inline char *put_dec(char *p, int value){
+	if (value >= 0) return put_dec(p, (unsigned)value);
+	*p++ = '-';
+	return put_dec(p, 0u - (unsigned)value);
+}
+
+static inline char *put_str(char *p, const char *s){
+	while (*s) *p++ = *s++;
+	return p;
+}
+
 void sim_pipe_fp::print_memory(unsigned start_address, unsigned end_address){
-	cout << "data_memory[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
+	unsigned size = (end_address > start_address) ? end_address - start_address : 0;
+#ifdef DEBUG_MEMORY
+	string buffer(32 + size * 3 + (size / 4 + 2) * 64, '\0');
+#else
+	string buffer(32 + size * 3 + (size / 4 + 2) * 13, '\0');
+#endif
+	char *begin = &buffer[0], *p = begin;
+	p = put_str(p, "data_memory[0x");
+	p = put_hex(p, start_address, 8);
+	p = put_str(p, ":0x");
+	p = put_hex(p, end_address, 8);
+	p = put_str(p, "]\n");
 	for (unsigned i=start_address; i<end_address; i++){
-		if (i%4 == 0) cout << "0x" << hex << setw(8) << setfill('0') << i << ": ";
-		cout << hex << setw(2) << setfill('0') << int(data_memory[i]) << " ";
+		if (i%4 == 0){
+			p = put_str(p, "0x");
+			p = put_hex(p, i, 8);
+			p = put_str(p, ": ");
+		}
+		p = put_hex(p, data_memory[i], 2);
+		*p++ = ' ';
 		if (i%4 == 3){
 #ifdef DEBUG_MEMORY
 			unsigned u = char2unsigned(&data_memory[i-3]);
-			cout << " - unsigned=" << u << " - float=" << unsigned2float(u);
+			p += sprintf(p, " - unsigned=%u - float=%g", u, unsigned2float(u));
 #endif
-			cout << endl;
+			*p++ = '\n';
 		}
 	}
+	cout.write(begin, p - begin);
+	cout << hex << setfill('0');	//stream state left as by the previous iostream version
+}
+
+void sim_pipe_fp::dump_memory(const char *filename, unsigned start_address, unsigned end_address){
+	if (end_address < start_address || end_address > data_memory_size){
+		cout << "ERROR:: invalid memory range [0x" << hex << start_address << ":0x" << end_address << "] for dump" << endl;
+		exit(-1);
+	}
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open memory dump file " << filename << endl;
+		exit(-1);
+	}
+	if (fwrite(data_memory + start_address, 1, end_address - start_address, file) != end_address - start_address){
+		cout << "ERROR:: cannot write memory dump file " << filename << endl;
+		exit(-1);
+	}
+	fclose(file);
+}
+
+/* =============   digest of the machine state ============== */
+
+/* digest of an aligned memory word; a word with all bytes at 0xFF (as after reset) contributes nothing,
+   so that the digest of the whole memory can be maintained with a xor per write */
+static inline unsigned long long word_digest(unsigned address, unsigned value){
+	if (value == UNDEFINED) return 0;
+	unsigned long long x = ((unsigned long long)address << 32) | value;
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/* digest of the aligned words overlapping [address, address+4) */
+static unsigned long long words_digest(unsigned char *memory, unsigned size, unsigned address){
+	unsigned long long digest = 0;
+	for (unsigned a = address & ~3u; a < address + 4; a += 4)
+		if (a + 4 <= size) digest ^= word_digest(a, char2unsigned(memory + a));
+	return digest;
+}
+
+/* digest of the aligned words overlapping [start_address, end_address) */
+static unsigned long long range_digest(unsigned char *memory, unsigned size, unsigned start_address, unsigned end_address){
+	unsigned long long digest = 0;
+	for (unsigned a = start_address & ~3u; a < end_address && a + 4 <= size; a += 4) digest ^= word_digest(a, char2unsigned(memory + a));
+	return digest;
+}
+
+static inline void digest_word(unsigned long long &digest, unsigned value){
+	digest = (digest ^ value) * 0x100000001b3ULL;
+}
+
+/* flags the lines of [address, address + size) written, if the simulator tracks its writes */
+static inline void mark_written(sim_pipe_fp *mSimPipe, unsigned address, unsigned long long size){
+	if (mSimPipe->written_lines.empty() || size == 0) return;
+	unsigned long long end = address + size;
+	if (end > mSimPipe->data_memory_size) end = mSimPipe->data_memory_size;
+	for (unsigned line = address / WRITE_TRACKING_LINE; (unsigned long long)line * WRITE_TRACKING_LINE < end; line++){
+		if (mSimPipe->written_lines[line]) continue;
+		mSimPipe->written_lines[line] = 1;
+		mSimPipe->written_list.push_back(line);
+	}
 }
 
 void sim_pipe_fp::write_memory(unsigned address, unsigned value){
+	if (memory_digest_valid) memory_digest ^= words_digest(data_memory, data_memory_size, address);
 	unsigned2char(value,data_memory+address);
+	if (memory_digest_valid) memory_digest ^= words_digest(data_memory, data_memory_size, address);
+	mark_written(this, address, 4);
+}
+
+void sim_pipe_fp::write_memory_block(unsigned address, const unsigned char *bytes, unsigned size){
+	if (address > data_memory_size || size > data_memory_size - address){
+		cout << "ERROR:: block of " << dec << size << " bytes at 0x" << hex << address << " does not fit in the data memory" << endl;
+		exit(-1);
+	}
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, address, address + size);
+	memcpy(data_memory + address, bytes, size);
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, address, address + size);
+	mark_written(this, address, size);
 }
 
+unsigned long long sim_pipe_fp::memory_hash(){
+	if (!memory_digest_valid){
+		memory_digest = range_digest(data_memory, data_memory_size, 0, data_memory_size);
+		memory_digest_valid = true;
+	}
+	return memory_digest;
+}
+
+unsigned long long sim_pipe_fp::state_hash(){
+	unsigned long long digest = memory_hash() ^ 0xcbf29ce484222325ULL;
+	for (unsigned s=0; s<NUM_STAGES; s++)
+		for (unsigned r=0; r<NUM_SP_REGISTERS; r++) digest_word(digest, get_sp_register((sp_register_t)r, (stage_t)s));
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+		digest_word(digest, get_int_register(r));
+		digest_word(digest, float2unsigned(get_fp_register(r)));
+	}
+	for (unsigned r=0; r<NUM_VECTOR_REGISTERS; r++)
+		for (unsigned e=0; e<MAX_VECTOR_LENGTH; e++) digest_word(digest, sim_pipe_vreg_file[r].regVal[e]);
+	return digest;
+}
+
+
+/* =============   data images ============== */
+
+void sim_pipe_fp::load_data_image(const char *filename, unsigned base_address){
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open data image " << filename << endl;
+		exit(-1);
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	check_image_range(filename, base_address, size, data_memory_size);
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, base_address, base_address + size);
+	if (fread(data_memory + base_address, 1, size, file) != (size_t)size){
+		cout << "ERROR:: cannot read data image " << filename << endl;
+		exit(-1);
+	}
+	if (memory_digest_valid) memory_digest ^= range_digest(data_memory, data_memory_size, base_address, base_address + size);
+	mark_written(this, base_address, size);
+	fclose(file);
+}
+
+void sim_pipe_fp::dump_data_image(const char *filename){
+	dump_memory(filename, 0, data_memory_size);
+}
+
+void sim_pipe_fp::map_data_image(const char *filename, unsigned base_address, bool shared){
+	if (base_address % sysconf(_SC_PAGESIZE) != 0){
+		cout << "ERROR:: data image " << filename << " must be mapped at a multiple of the page size (0x" << hex << base_address << ")" << endl;
+		exit(-1);
+	}
+	int fd = open(filename, shared ? O_RDWR : O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0){
+		cout << "ERROR:: cannot open data image " << filename << endl;
+		exit(-1);
+	}
+	check_image_range(filename, base_address, info.st_size, data_memory_size);
+	if (info.st_size > 0 && mmap(data_memory + base_address, info.st_size, PROT_READ | PROT_WRITE,
+	                             (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_FIXED, fd, 0) == MAP_FAILED){
+		cout << "ERROR:: cannot map data image " << filename << endl;
+		exit(-1);
+	}
+	close(fd);
+	memory_digest_valid = false;
+	data_image_mapped = true;
+	mark_written(this, base_address, info.st_size);
+}
+
+
+/* formats one register line: "<name> = <value> / 0x<hex>" */
+static inline char *put_register(char *p, const char *name, unsigned index, unsigned value, bool is_signed){
+	p = put_str(p, name);
+	if (index != UNDEFINED) p = put_dec(p, index);
+	p = put_str(p, " = ");
+	p = is_signed ? put_dec(p, (int)value) : put_dec(p, value);
+	p = put_str(p, " / 0x");
+	p = put_hex(p, value);
+	*p++ = '\n';
+	return p;
+}
+
+/* formats one floating point register line: "<name> = <value> / 0x<hex>" */
+static inline char *put_fp_register(char *p, const char *name, unsigned index, unsigned element, float value){
+	p = put_str(p, name);
+	p = put_dec(p, index);
+	if (element != UNDEFINED){
+		*p++ = '[';
+		p = put_dec(p, element);
+		*p++ = ']';
+	}
+	p += sprintf(p, " = %g / 0x", value);
+	p = put_hex(p, float2unsigned(value));
+	*p++ = '\n';
+	return p;
+}
 
 void sim_pipe_fp::print_registers(){
-        cout << "Special purpose registers:" << endl;
-        unsigned i, s;
-        for (s=0; s<NUM_STAGES; s++){
-                cout << "Stage: " << stage_names[s] << endl;
-                for (i=0; i< NUM_SP_REGISTERS; i++)
-                        if ((sp_register_t)i != IR && (sp_register_t)i != COND && get_sp_register((sp_register_t)i, (stage_t)s)!=UNDEFINED) cout << reg_names[i] << " = " << dec <<  get_sp_register((sp_register_t)i, (stage_t)s) << hex << " / 0x" << get_sp_register((sp_register_t)i, (stage_t)s) << endl;
-        }
-        cout << "General purpose registers:" << endl;
-        for (i=0; i< NUM_GP_REGISTERS; i++)
-                if (get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << get_int_register(i) << hex << " / 0x" << get_int_register(i) << endl;
-        for (i=0; i< NUM_GP_REGISTERS; i++)
-                if (float2unsigned(get_fp_register(i))!=UNDEFINED) cout << "F" << dec << i << " = " << get_fp_register(i) << hex << " / 0x" << float2unsigned(get_fp_register(i)) << endl;
+	string buffer(32 + NUM_STAGES * (16 + NUM_SP_REGISTERS * 48) + (2 * NUM_GP_REGISTERS + NUM_VECTOR_REGISTERS * MAX_VECTOR_LENGTH) * 64, '\0');
+	char *begin = &buffer[0], *p = begin;
+	bool printed = false;
+	unsigned i, s;
+	p = put_str(p, "Special purpose registers:\n");
+	for (s=0; s<NUM_STAGES; s++){
+		p = put_str(p, "Stage: ");
+		p = put_str(p, stage_names[s]);
+		*p++ = '\n';
+		for (i=0; i< NUM_SP_REGISTERS; i++){
+			if ((sp_register_t)i == IR || (sp_register_t)i == COND) continue;
+			unsigned value = get_sp_register((sp_register_t)i, (stage_t)s);
+			if (value == UNDEFINED) continue;
+			p = put_register(p, reg_names[i], UNDEFINED, value, false);
+			printed = true;
+		}
+	}
+	p = put_str(p, "General purpose registers:\n");
+	for (i=0; i< NUM_GP_REGISTERS; i++){
+		int value = get_int_register(i);
+		if (value == (int)UNDEFINED) continue;
+		p = put_register(p, "R", i, value, true);
+		printed = true;
+	}
+	for (i=0; i< NUM_GP_REGISTERS; i++){
+		float value = get_fp_register(i);
+		if (float2unsigned(value) == UNDEFINED) continue;
+		p = put_fp_register(p, "F", i, UNDEFINED, value);
+		printed = true;
+	}
+	for (i=0; i< NUM_VECTOR_REGISTERS; i++)
+		for (s=0; s< vector_length; s++){
+			float value = get_vector_register(i, s);
+			if (float2unsigned(value) == UNDEFINED) continue;
+			p = put_fp_register(p, "V", i, s, value);
+			printed = true;
+		}
+	cout.write(begin, p - begin);
+	if (printed) cout << hex;	//stream state left as by the previous iostream version
 }
 
 
@@ -220,6 +599,7 @@ void sim_pipe_fp::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigne
         sim_pipe_pipeline_reg_EXE[num_units].Imm = UNDEFINED;
         sim_pipe_pipeline_reg_EXE[num_units].A = UNDEFINED;
         sim_pipe_pipeline_reg_EXE[num_units].B = UNDEFINED;
+        sim_pipe_pipeline_reg_EXE[num_units].C = UNDEFINED;
         sim_pipe_pipeline_reg_EXE[num_units].ALU_Output = UNDEFINED;
         sim_pipe_pipeline_reg_EXE[num_units].Cond = UNDEFINED;
         sim_pipe_pipeline_reg_EXE[num_units].LMD = UNDEFINED;
@@ -229,50 +609,69 @@ void sim_pipe_fp::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigne
 	}
 }
 
+/* returns the type of execution unit required by the given opcode */
+exe_unit_t unit_type(opcode_t opcode){
+	switch(opcode){
+		//Integer unit
+		case LW:
+		case SW:
+		case ADD:
+		case ADDI:
+		case SUB:
+		case SUBI:
+		case XOR:
+		case BEQZ:
+		case BNEZ:
+		case BLTZ:
+		case BGTZ:
+		case BLEZ:
+		case BGEZ:
+		case JUMP:
+		case LWS:
+		case SWS:
+		case LOOP:
+			return INTEGER;
+		// FP adder
+		case ADDS:
+		case SUBS:
+			return ADDER;
+		// Multiplier
+		case MULTS:
+			return MULTIPLIER;
+		// Divider
+		case DIVS:
+			return DIVIDER;
+		// Fused multiply-add unit
+		case FMADDS:
+			return FMA;
+		// Vector adder
+		case ADDV:
+		case SUBV:
+			return VECTOR_ADDER;
+		// Vector multiplier
+		case MULV:
+			return VECTOR_MULTIPLIER;
+		// Vector load/store unit
+		case LV:
+		case SV:
+		case LVWS:
+		case SVWS:
+			return VECTOR_MEMORY;
+		default:
+			cout << "ERROR:: operations not requiring exec unit!\n";
+			exit(-1);
+	}
+}
+
 /* returns a free unit for that particular operation or UNDEFINED if no unit is currently available */
 unsigned sim_pipe_fp::get_free_unit(opcode_t opcode){
 	if (num_units == 0){
 		cout << "ERROR:: simulator does not have any execution units!\n";
 		exit(-1);
 	}
+	exe_unit_t type = unit_type(opcode);
 	for (unsigned u=0; u<num_units; u++){
-		switch(opcode){
-			//Integer unit
-			case LW:
-			case SW:
-			case ADD:
-			case ADDI:
-			case SUB:
-			case SUBI:
-			case XOR:
-			case BEQZ:
-			case BNEZ:
-			case BLTZ:
-			case BGTZ:
-			case BLEZ:
-			case BGEZ:
-			case JUMP:
-			case LWS:
-			case SWS:
-				if (exec_units[u].type==INTEGER && exec_units[u].busy==0) return u;
-				break;
-			// FP adder
-			case ADDS:
-			case SUBS:
-				if (exec_units[u].type==ADDER && exec_units[u].busy==0) return u;
-				break;
-			// Multiplier
-			case MULTS:
-				if (exec_units[u].type==MULTIPLIER && exec_units[u].busy==0) return u;
-				break;
-			// Divider
-			case DIVS:
-				if (exec_units[u].type==DIVIDER && exec_units[u].busy==0) return u;
-				break;
-			default:
-				cout << "ERROR:: operations not requiring exec unit!\n";
-				exit(-1);
-		}
+		if (exec_units[u].type==type && exec_units[u].busy==0) return u;
 	}
 	return UNDEFINED;
 }
@@ -295,9 +694,86 @@ void sim_pipe_fp::debug_units(){
 
 /* ========= end primitives related to functional units ===============*/
 
+/* returns the instruction at the given address; while a hardware loop is active the loop body
+   is captured in the loop buffer on the first iteration and served from there afterwards */
+instruction_t sim_pipe_fp::fetch_instruction(unsigned pc){
+	unsigned index = (pc - instr_base_address) / 4;
+	if (loop_counter != 0 && pc >= loop_start){
+		unsigned offset = (pc - loop_start) / 4;
+		if (offset < loop_buffer_valid){
+			loop_buffer_hits++;
+			return loop_buffer[offset];
+		}
+		if (offset == loop_buffer_valid && offset < LOOP_BUFFER_SIZE){
+			loop_buffer[offset] = instr_memory[index];
+			loop_buffer_valid++;
+		}
+	}
+	return instr_memory[index];
+}
+
 
 /* ========================parser ==================================== */
 
+/* a segment of initialized data declared in an assembly file */
+typedef struct{
+	unsigned address;
+	vector<unsigned char> bytes;
+} data_segment_t;
+
+/* parses a data directive, whose operands are read with strtok:
+   .data [address]   starts a segment at address (by default, where the previous segment ended)
+   .word v1 v2 ...   32-bit integers
+   .float v1 v2 ...  single precision values
+   .space n          n bytes at 0
+   .text             returns to the instructions (accepted for readability only) */
+static void parse_data_directive(const char *filename, const char *directive, vector<data_segment_t> &segments){
+	char *operand, *end;
+	if (!strcmp(directive, ".text")) return;
+	if (!strcmp(directive, ".data")){
+		data_segment_t segment;
+		operand = strtok(NULL, " \t\r");
+		if (operand != NULL){
+			segment.address = strtoul(operand, &end, 0);
+			if (*end != '\0'){
+				cout << "ERROR:: invalid address " << operand << " for .data in " << filename << endl;
+				exit(-1);
+			}
+		}else if (!segments.empty()){
+			segment.address = segments.back().address + segments.back().bytes.size();
+		}else{
+			cout << "ERROR:: the first .data in " << filename << " must specify an address" << endl;
+			exit(-1);
+		}
+		segments.push_back(segment);
+		return;
+	}
+	bool is_word = !strcmp(directive, ".word");
+	bool is_float = !strcmp(directive, ".float");
+	if (!is_word && !is_float && strcmp(directive, ".space")){
+		cout << "ERROR:: unknown directive " << directive << " in " << filename << endl;
+		exit(-1);
+	}
+	if (segments.empty()){
+		cout << "ERROR:: " << directive << " outside of a .data segment in " << filename << endl;
+		exit(-1);
+	}
+	vector<unsigned char> &bytes = segments.back().bytes;
+	while ((operand = strtok(NULL, " \t\r,")) != NULL){
+		unsigned value;
+		if (is_float){
+			float f = strtof(operand, &end);
+			memcpy(&value, &f, sizeof value);
+		}else value = (unsigned)strtoll(operand, &end, 0);
+		if (*end != '\0'){
+			cout << "ERROR:: invalid operand " << operand << " for " << directive << " in " << filename << endl;
+			exit(-1);
+		}
+		if (is_word || is_float) for (unsigned b=0; b<4; b++) bytes.push_back(value >> (8*b));
+		else bytes.insert(bytes.end(), value, 0);
+	}
+}
+
 void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
 
    /* initializing the base instruction address */
@@ -305,7 +781,7 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
 
    /* creating a map with the valid opcodes and with the valid labels */
    map<string, opcode_t> opcodes; //for opcodes
-   map<string, unsigned> labels;  //for branches
+   labels.clear();  //for branches
    for (int i=0; i<NUM_OPCODES; i++)
 	 opcodes[string(instr_names[i])]=(opcode_t)i;
 
@@ -319,13 +795,23 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
    /* parsing the assembly file line by line */
    string line;
    unsigned instruction_nr = 0;
+   vector<data_segment_t> segments;
    while (getline(fin,line)){
+	if (instruction_nr >= PROGRAM_SIZE){
+		cout << "ERROR:: program " << filename << " larger than " << PROGRAM_SIZE << " instructions" << endl;
+		exit(-1);
+	}
 
 	// set the instruction field
 	char *str = const_cast<char*>(line.c_str());
 
   	// tokenize the instruction
 	char *token = strtok (str," \t");
+	if (token == NULL) continue;
+	if (token[0] == '.'){
+		parse_data_directive(filename, token, segments);
+		continue;
+	}
 	map<string, opcode_t>::iterator search = opcodes.find(token);
         if (search == opcodes.end()){
 		// this is a label for a branch - extract it and save it in the labels map
@@ -342,6 +828,7 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
 	char *par1;
 	char *par2;
 	char *par3;
+	char *par4;
 	switch(instr_memory[instruction_nr].opcode){
 		case ADD:
 		case SUB:
@@ -396,6 +883,51 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
 		case JUMP:
 			par2 = strtok (NULL, " \t");
 			instr_memory[instruction_nr].label = par2;
+			break;
+		case LOOP:
+			par1 = strtok (NULL, " \t");
+			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "R"));
+			break;
+		case LV:
+		case LVWS:
+			par1 = strtok (NULL, " \t");
+			par2 = strtok (NULL, " \t");
+			par3 = strtok (NULL, " \t");
+			instr_memory[instruction_nr].dest = atoi(strtok(par1, "V"));
+			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
+			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
+			if (instr_memory[instruction_nr].opcode == LVWS) instr_memory[instruction_nr].src3 = atoi(strtok(par3, "R"));
+			break;
+		case SV:
+		case SVWS:
+			par1 = strtok (NULL, " \t");
+			par2 = strtok (NULL, " \t");
+			par3 = strtok (NULL, " \t");
+			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "V"));
+			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
+			instr_memory[instruction_nr].src2 = atoi(strtok(NULL, "R"));
+			if (instr_memory[instruction_nr].opcode == SVWS) instr_memory[instruction_nr].src3 = atoi(strtok(par3, "R"));
+			break;
+		case FMADDS:
+			par1 = strtok (NULL, " \t");
+			par2 = strtok (NULL, " \t");
+			par3 = strtok (NULL, " \t");
+			par4 = strtok (NULL, " \t");
+			instr_memory[instruction_nr].dest = atoi(strtok(par1, "F"));
+			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "F"));
+			instr_memory[instruction_nr].src2 = atoi(strtok(par3, "F"));
+			instr_memory[instruction_nr].src3 = atoi(strtok(par4, "F"));
+			break;
+		case ADDV:
+		case SUBV:
+		case MULV:
+			par1 = strtok (NULL, " \t");
+			par2 = strtok (NULL, " \t");
+			par3 = strtok (NULL, " \t");
+			instr_memory[instruction_nr].dest = atoi(strtok(par1, "V"));
+			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "V"));
+			instr_memory[instruction_nr].src2 = atoi(strtok(par3, "V"));
+			break;
 		default:
 			break;
 
@@ -404,6 +936,9 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
 	/* increment instruction number before moving to next line */
 	instruction_nr++;
    }
+   //copying the data segments into the data memory, one block per segment
+   for (unsigned s=0; s<segments.size(); s++)
+	if (!segments[s].bytes.empty()) write_memory_block(segments[s].address, &segments[s].bytes[0], segments[s].bytes.size());
    //reconstructing the labels of the branch operations
    int i = 0;
    while(true){
@@ -421,6 +956,464 @@ void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
     sim_pipe_pipeline_reg[IF].PC = instr_base_address;
 }
 
+/* ======================== static list scheduler ==================================== */
+
+#define SCHED_INT_REG(r)    (r)
+#define SCHED_FP_REG(r)     (REGISTER_FILE_SIZE + (r))
+#define SCHED_VECTOR_REG(r) (2 * REGISTER_FILE_SIZE + (r))
+
+/* registers read and written by an instruction (as stored in instruction memory) */
+typedef struct{
+	vector<unsigned> uses;
+	vector<unsigned> defs;
+	bool is_load;
+	bool is_store;
+	unsigned base;       //base register of a scalar memory access (UNDEFINED otherwise)
+} sched_info_t;
+
+static sched_info_t sched_get_info(const instruction_t &instr){
+	sched_info_t info;
+	info.is_load = (instr.opcode == LW || instr.opcode == LWS || instr.opcode == LV || instr.opcode == LVWS);
+	info.is_store = (instr.opcode == SW || instr.opcode == SWS || is_vector_store(instr.opcode));
+	info.base = UNDEFINED;
+	switch(instr.opcode){
+		case ADD: case SUB: case XOR:
+			info.defs.push_back(SCHED_INT_REG(instr.dest));
+			info.uses.push_back(SCHED_INT_REG(instr.src1));
+			info.uses.push_back(SCHED_INT_REG(instr.src2));
+			break;
+		case ADDI: case SUBI:
+			info.defs.push_back(SCHED_INT_REG(instr.dest));
+			info.uses.push_back(SCHED_INT_REG(instr.src1));
+			break;
+		case LW: case LWS:
+			info.defs.push_back((instr.opcode == LW) ? SCHED_INT_REG(instr.dest) : SCHED_FP_REG(instr.dest));
+			info.uses.push_back(SCHED_INT_REG(instr.src1));
+			info.base = instr.src1;
+			break;
+		case SW: case SWS:
+			info.uses.push_back((instr.opcode == SW) ? SCHED_INT_REG(instr.src1) : SCHED_FP_REG(instr.src1));
+			info.uses.push_back(SCHED_INT_REG(instr.src2));
+			info.base = instr.src2;
+			break;
+		case FMADDS:
+			info.uses.push_back(SCHED_FP_REG(instr.src3));
+			/* fall through */
+		case ADDS: case SUBS: case MULTS: case DIVS:
+			info.defs.push_back(SCHED_FP_REG(instr.dest));
+			info.uses.push_back(SCHED_FP_REG(instr.src1));
+			info.uses.push_back(SCHED_FP_REG(instr.src2));
+			break;
+		case LV: case LVWS:
+			info.defs.push_back(SCHED_VECTOR_REG(instr.dest));
+			info.uses.push_back(SCHED_INT_REG(instr.src1));
+			if (instr.src3 < REGISTER_FILE_SIZE) info.uses.push_back(SCHED_INT_REG(instr.src3));
+			break;
+		case SV: case SVWS:
+			info.uses.push_back(SCHED_VECTOR_REG(instr.src1));
+			info.uses.push_back(SCHED_INT_REG(instr.src2));
+			if (instr.src3 < REGISTER_FILE_SIZE) info.uses.push_back(SCHED_INT_REG(instr.src3));
+			break;
+		case ADDV: case SUBV: case MULV:
+			info.defs.push_back(SCHED_VECTOR_REG(instr.dest));
+			info.uses.push_back(SCHED_VECTOR_REG(instr.src1));
+			info.uses.push_back(SCHED_VECTOR_REG(instr.src2));
+			break;
+		case BEQZ: case BNEZ: case BLTZ: case BGTZ: case BLEZ: case BGEZ: case LOOP:
+			info.uses.push_back(SCHED_INT_REG(instr.src1));
+			break;
+		default:
+			break;
+	}
+	return info;
+}
+
+/* true if the two memory accesses may touch the same location */
+static bool sched_may_alias(const instruction_t &a, const sched_info_t &ia, const instruction_t &b, const sched_info_t &ib, bool base_redefined){
+	if (ia.base == UNDEFINED || ib.base == UNDEFINED || ia.base != ib.base || base_redefined) return true;
+	int delta = (int)a.immediate - (int)b.immediate;
+	return (delta > -4 && delta < 4);
+}
+
+/* list-schedules the instructions in [first, last) - the block terminator is not part of the range */
+static void sched_block(sim_pipe_fp *sim, unsigned first, unsigned last){
+	unsigned n = last - first;
+	if (n < 2) return;
+
+	vector<instruction_t> instrs(sim->instr_memory + first, sim->instr_memory + last);
+	vector<sched_info_t> info(n);
+	vector<unsigned> latency(n);
+	vector<int> exe_type(n);
+	for (unsigned i=0; i<n; i++){
+		info[i] = sched_get_info(instrs[i]);
+		// latency and unit type taken from the configured execution units
+		latency[i] = 1;
+		exe_type[i] = -1;
+		for (unsigned u=0; u<sim->num_units && instrs[i].opcode != NOP; u++){
+			if (sim->exec_units[u].type == unit_type(instrs[i].opcode)){
+				exe_type[i] = sim->exec_units[u].type;
+				latency[i] = sim->exec_units[u].latency;
+				if (is_vector(instrs[i].opcode)) latency[i] += sim->vector_length - 1;
+				break;
+			}
+		}
+		if (info[i].is_load) latency[i] += sim->data_memory_latency;
+	}
+
+	// dependence graph: edge i->j (i<j) with the minimum distance between the two issue slots
+	vector< vector<unsigned> > succ(n), dist(n);
+	vector<unsigned> npred(n, 0);
+	for (unsigned j=0; j<n; j++){
+		for (unsigned i=0; i<j; i++){
+			unsigned d = 0;
+			bool dep = false;
+			for (unsigned a=0; a<info[i].defs.size(); a++){
+				for (unsigned b=0; b<info[j].uses.size(); b++)
+					if (info[i].defs[a] == info[j].uses[b]){ dep = true; if (latency[i] > d) d = latency[i]; }   // RAW
+				for (unsigned b=0; b<info[j].defs.size(); b++)
+					if (info[i].defs[a] == info[j].defs[b]){ dep = true; if (d < 1) d = 1; }                      // WAW
+			}
+			for (unsigned a=0; a<info[i].uses.size(); a++)
+				for (unsigned b=0; b<info[j].defs.size(); b++)
+					if (info[i].uses[a] == info[j].defs[b]){ dep = true; if (d < 1) d = 1; }                      // WAR
+			if ((info[i].is_store && (info[j].is_load || info[j].is_store)) || (info[i].is_load && info[j].is_store)){
+				bool base_redefined = false;
+				for (unsigned k=i; k<j && info[i].base != UNDEFINED; k++)
+					for (unsigned a=0; a<info[k].defs.size(); a++)
+						if (info[k].defs[a] == SCHED_INT_REG(info[i].base)) base_redefined = true;
+				if (sched_may_alias(instrs[i], info[i], instrs[j], info[j], base_redefined)){ dep = true; if (d < 1) d = 1; }
+			}
+			if (dep){
+				succ[i].push_back(j);
+				dist[i].push_back(d);
+				npred[j]++;
+			}
+		}
+	}
+
+	// priority: latency-weighted height of each instruction in the dependence graph
+	vector<unsigned> height(n, 0);
+	for (int i=n-1; i>=0; i--){
+		height[i] = latency[i];
+		for (unsigned k=0; k<succ[i].size(); k++)
+			if (dist[i][k] + height[succ[i][k]] > height[i]) height[i] = dist[i][k] + height[succ[i][k]];
+	}
+
+	// cycle-by-cycle list scheduling, one issue per cycle, honoring the number of units of each type
+	vector<unsigned> earliest(n, 0);
+	vector<bool> scheduled(n, false);
+	vector<unsigned> unit_free(sim->num_units, 0);
+	vector<instruction_t> order;
+	unsigned cycle = 0;
+	while (order.size() < n){
+		int best = -1;
+		unsigned best_unit = UNDEFINED;
+		for (unsigned i=0; i<n; i++){
+			if (scheduled[i] || npred[i] != 0 || earliest[i] > cycle) continue;
+			unsigned free_unit = UNDEFINED;
+			for (unsigned u=0; u<sim->num_units && exe_type[i] >= 0; u++)
+				if ((int)sim->exec_units[u].type == exe_type[i] && unit_free[u] <= cycle){ free_unit = u; break; }
+			if (exe_type[i] >= 0 && free_unit == UNDEFINED) continue;
+			if (best == -1 || height[i] > height[best]){ best = i; best_unit = free_unit; }
+		}
+		if (best != -1){
+			scheduled[best] = true;
+			order.push_back(instrs[best]);
+			if (best_unit != UNDEFINED) unit_free[best_unit] = cycle + latency[best] - (info[best].is_load ? sim->data_memory_latency : 0);
+			for (unsigned k=0; k<succ[best].size(); k++){
+				npred[succ[best][k]]--;
+				if (cycle + dist[best][k] > earliest[succ[best][k]]) earliest[succ[best][k]] = cycle + dist[best][k];
+			}
+		}
+		cycle++;
+	}
+	for (unsigned i=0; i<n; i++) sim->instr_memory[first + i] = order[i];
+}
+
+void sim_pipe_fp::schedule_program(){
+	// program length
+	unsigned size = 0;
+	while (size < PROGRAM_SIZE && instr_memory[size].opcode != EOP) size++;
+
+	// basic block leaders: branch targets, instructions following a branch and hardware loop boundaries
+	vector<bool> leader(size + 1, false);
+	leader[0] = true;
+	leader[size] = true;
+	for (unsigned i=0; i<size; i++){
+		if (is_branch(instr_memory[i].opcode)){
+			int target = (int)i + 1 + ((int)instr_memory[i].immediate >> 2);
+			if (target >= 0 && (unsigned)target <= size) leader[target] = true;
+			leader[i + 1] = true;
+		}
+		if (instr_memory[i].opcode == LOOP || instr_memory[i].opcode == ENDLOOP){
+			leader[i] = true;
+			leader[i + 1] = true;
+		}
+	}
+
+	// schedule each block, leaving its terminating branch/LOOP/ENDLOOP in place
+	unsigned first = 0;
+	for (unsigned i=1; i<=size; i++){
+		if (!leader[i]) continue;
+		unsigned last = i;
+		opcode_t terminator = instr_memory[i - 1].opcode;
+		if (is_branch(terminator) || terminator == LOOP || terminator == ENDLOOP) last = i - 1;
+		if (last > first) sched_block(this, first, last);
+		first = i;
+	}
+}
+
+/* ======================== loop unrolling ==================================== */
+
+/* returns the absolute target (instruction index) of a branch */
+static int branch_target(const instruction_t &instr, unsigned index){
+	return (int)index + 1 + ((int)instr.immediate >> 2);
+}
+
+/* returns true if the instruction is ADDI/SUBI "reg reg c", storing the signed increment in "step" */
+static bool is_increment(const instruction_t &instr, unsigned reg, int *step){
+	if ((instr.opcode != ADDI && instr.opcode != SUBI) || instr.dest != reg || instr.src1 != reg) return false;
+	*step = (instr.opcode == ADDI) ? (int)instr.immediate : -(int)instr.immediate;
+	return (*step != 0);
+}
+
+/* unrolled program entry: an instruction plus the (old or new) index of its branch target */
+typedef struct{
+	instruction_t instr;
+	int old_target;   //target in the original program, -1 if none
+	int new_target;   //target in the unrolled program, -1 if none
+} unroll_entry_t;
+
+static unroll_entry_t unroll_entry(const instruction_t &instr, int old_target, int new_target){
+	unroll_entry_t e;
+	e.instr = instr;
+	e.old_target = old_target;
+	e.new_target = new_target;
+	return e;
+}
+
+static instruction_t unroll_make(opcode_t opcode, unsigned dest, unsigned src1, unsigned immediate, const string &label){
+	instruction_t instr;
+	instr.opcode = opcode;
+	instr.dest = dest;
+	instr.src1 = src1;
+	instr.src2 = UNDEFINED;
+	instr.src3 = UNDEFINED;
+	instr.immediate = immediate;
+	instr.label = label;
+	return instr;
+}
+
+/* returns the instruction with its registers mapped through "renamed" (indexed by SCHED_*_REG) */
+static instruction_t sched_rename(const instruction_t &instr, const vector<unsigned> &renamed){
+	instruction_t r = instr;
+	#define RENAME_INT(f) if (r.f < REGISTER_FILE_SIZE) r.f = renamed[SCHED_INT_REG(r.f)] - SCHED_INT_REG(0)
+	#define RENAME_FP(f) if (r.f < REGISTER_FILE_SIZE) r.f = renamed[SCHED_FP_REG(r.f)] - SCHED_FP_REG(0)
+	switch(instr.opcode){
+		case ADD: case SUB: case XOR: case ADDI: case SUBI: case LW:
+			RENAME_INT(dest); RENAME_INT(src1); RENAME_INT(src2);
+			break;
+		case LWS:
+			RENAME_FP(dest); RENAME_INT(src1);
+			break;
+		case SW:
+			RENAME_INT(src1); RENAME_INT(src2);
+			break;
+		case SWS:
+			RENAME_FP(src1); RENAME_INT(src2);
+			break;
+		case ADDS: case SUBS: case MULTS: case DIVS: case FMADDS:
+			RENAME_FP(dest); RENAME_FP(src1); RENAME_FP(src2); RENAME_FP(src3);
+			break;
+		case LV: case LVWS:
+			RENAME_INT(src1); RENAME_INT(src3);
+			break;
+		case SV: case SVWS:
+			RENAME_INT(src2); RENAME_INT(src3);
+			break;
+		default:
+			break;
+	}
+	#undef RENAME_INT
+	#undef RENAME_FP
+	return r;
+}
+
+void sim_pipe_fp::unroll_loops(unsigned factor){
+	if (factor < 2) return;
+
+	unsigned size = 0;
+	while (size < PROGRAM_SIZE && instr_memory[size].opcode != EOP) size++;
+
+	// registers referenced by the program (per class) - the others are free for renaming
+	vector<bool> used(2 * REGISTER_FILE_SIZE, false);
+	for (unsigned i=0; i<size; i++){
+		sched_info_t info = sched_get_info(instr_memory[i]);
+		for (unsigned k=0; k<info.uses.size(); k++) if (info.uses[k] < 2 * REGISTER_FILE_SIZE) used[info.uses[k]] = true;
+		for (unsigned k=0; k<info.defs.size(); k++) if (info.defs[k] < 2 * REGISTER_FILE_SIZE) used[info.defs[k]] = true;
+	}
+	used[SCHED_INT_REG(0)] = true;
+	vector<unsigned> free_regs;
+	for (unsigned r=0; r<2 * REGISTER_FILE_SIZE; r++) if (!used[r]) free_regs.push_back(r);
+	// scratch register holding the remaining-iterations check
+	unsigned scratch = UNDEFINED;
+	for (unsigned k=0; k<free_regs.size(); k++){
+		if (free_regs[k] < REGISTER_FILE_SIZE){
+			scratch = free_regs[k];
+			free_regs.erase(free_regs.begin() + k);
+			break;
+		}
+	}
+	if (scratch == UNDEFINED) return;
+
+	// branch targets in the original program
+	vector<int> targets(size, -1);
+	vector<unsigned> target_count(size + 1, 0);
+	for (unsigned i=0; i<size; i++){
+		if (is_branch(instr_memory[i].opcode)){
+			targets[i] = branch_target(instr_memory[i], i);
+			if (targets[i] >= 0 && targets[i] <= (int)size) target_count[targets[i]]++;
+		}
+	}
+
+	vector<unroll_entry_t> out;
+	vector<int> old2new(size + 1, -1);
+	map<string, unsigned> new_labels;
+	unsigned i = 0;
+	while (i < size){
+		// look for a simple counted loop starting at i: body [i, e) closed by "BNEZ Rb" at e
+		unsigned e = i;
+		while (e < size && !(is_branch(instr_memory[e].opcode) || instr_memory[e].opcode == LOOP || instr_memory[e].opcode == ENDLOOP)) e++;
+		bool simple = (e < size && e > i && instr_memory[e].opcode == BNEZ && targets[e] == (int)i);
+		for (unsigned k=i+1; k<=e && simple; k++) if (target_count[k] != 0) simple = false;
+
+		unsigned branch_reg = simple ? instr_memory[e].src1 : UNDEFINED;
+		unsigned iv = UNDEFINED, compare = UNDEFINED;
+		int step = 0, bound = 0;
+		if (simple){
+			// the branch register must have a single definition in the body and no other use
+			unsigned ndefs = 0, def = UNDEFINED;
+			for (unsigned k=i; k<e; k++){
+				sched_info_t info = sched_get_info(instr_memory[k]);
+				for (unsigned a=0; a<info.defs.size(); a++) if (info.defs[a] == SCHED_INT_REG(branch_reg)){ ndefs++; def = k; }
+				for (unsigned a=0; a<info.uses.size(); a++) if (info.uses[a] == SCHED_INT_REG(branch_reg) && !(k == def && instr_memory[k].src1 == branch_reg && instr_memory[k].dest == branch_reg)) simple = false;
+			}
+			if (ndefs != 1) simple = false;
+			if (simple && is_increment(instr_memory[def], branch_reg, &step)){
+				// the branch tests the counter itself
+				iv = branch_reg;
+				bound = 0;
+			}else if (simple && (instr_memory[def].opcode == SUBI || instr_memory[def].opcode == ADDI) && instr_memory[def].src1 != branch_reg){
+				// the branch tests "iv - bound", iv being updated once before the comparison
+				iv = instr_memory[def].src1;
+				bound = (instr_memory[def].opcode == SUBI) ? (int)instr_memory[def].immediate : -(int)instr_memory[def].immediate;
+				compare = def;
+				unsigned nupdates = 0;
+				for (unsigned k=i; k<e; k++){
+					sched_info_t info = sched_get_info(instr_memory[k]);
+					for (unsigned a=0; a<info.defs.size(); a++){
+						if (info.defs[a] == SCHED_INT_REG(iv)){
+							nupdates++;
+							if (k > def || !is_increment(instr_memory[k], iv, &step)) simple = false;
+						}
+					}
+				}
+				if (nupdates != 1) simple = false;
+			}else{
+				simple = false;
+			}
+		}
+
+		// size of the transformed loop: guard + unrolled copies + check + remainder loop
+		unsigned body = e - i - ((compare != UNDEFINED) ? 1 : 0);
+		if (simple && (out.size() + (size - i) + 4 + factor * body + 1 > PROGRAM_SIZE)){
+			cout << "WARNING: loop at instruction " << i << " not unrolled (program larger than PROGRAM_SIZE)" << endl;
+			simple = false;
+		}
+		if (!simple){
+			old2new[i] = out.size();
+			out.push_back(unroll_entry(instr_memory[i], targets[i], -1));
+			i++;
+			continue;
+		}
+
+		// loop-local registers: defined in the body before being read
+		vector<unsigned> local;
+		vector<bool> seen_use(2 * REGISTER_FILE_SIZE, false), seen_def(2 * REGISTER_FILE_SIZE, false);
+		for (unsigned k=i; k<e; k++){
+			if (k == compare) continue;
+			sched_info_t info = sched_get_info(instr_memory[k]);
+			for (unsigned a=0; a<info.uses.size(); a++) if (info.uses[a] < 2 * REGISTER_FILE_SIZE) seen_use[info.uses[a]] = true;
+			for (unsigned a=0; a<info.defs.size(); a++){
+				unsigned r = info.defs[a];
+				if (r < 2 * REGISTER_FILE_SIZE && !seen_use[r] && !seen_def[r] && r != SCHED_INT_REG(iv)) local.push_back(r);
+				if (r < 2 * REGISTER_FILE_SIZE) seen_def[r] = true;
+			}
+		}
+
+		string label = instr_memory[e].label;
+		int step_k = step * (int)factor;
+		unsigned check = (unsigned)(bound - step_k);
+		int unrolled_start, remainder_start;
+
+		// guard: enter the unrolled loop only if more than "factor" iterations remain
+		old2new[i] = out.size();
+		out.push_back(unroll_entry(unroll_make(SUBI, scratch, iv, check, ""), -1, -1));
+		out.push_back(unroll_entry(unroll_make((step > 0) ? BGEZ : BLEZ, UNDEFINED, scratch, 0, label + "_REM"), -1, -1));
+		unsigned guard_branch = out.size() - 1;
+		unrolled_start = out.size();
+		for (unsigned c=0; c<factor; c++){
+			// rename the loop-local registers of all the copies but the last one
+			vector<unsigned> renamed(SCHED_VECTOR_REG(NUM_VECTOR_REGISTERS));
+			for (unsigned r=0; r<renamed.size(); r++) renamed[r] = r;
+			for (unsigned l=0; l<local.size() && c < factor - 1; l++){
+				for (unsigned k=0; k<free_regs.size(); k++){
+					if ((free_regs[k] < REGISTER_FILE_SIZE) == (local[l] < REGISTER_FILE_SIZE)){
+						renamed[local[l]] = free_regs[k];
+						free_regs.erase(free_regs.begin() + k);
+						break;
+					}
+				}
+			}
+			for (unsigned k=i; k<e; k++){
+				if (k == compare) continue;
+				out.push_back(unroll_entry(sched_rename(instr_memory[k], renamed), -1, -1));
+			}
+		}
+		// back edge of the unrolled loop
+		out.push_back(unroll_entry(unroll_make(SUBI, scratch, iv, check, ""), -1, -1));
+		out.push_back(unroll_entry(unroll_make((step > 0) ? BLTZ : BGTZ, UNDEFINED, scratch, 0, label + "_UNROLLED"), -1, unrolled_start));
+		// remainder: the original loop
+		remainder_start = out.size();
+		out[guard_branch].new_target = remainder_start;
+		new_labels[label + "_UNROLLED"] = unrolled_start;
+		new_labels[label + "_REM"] = remainder_start;
+		for (unsigned k=i; k<e; k++){
+			if (k != i) old2new[k] = out.size();
+			out.push_back(unroll_entry(instr_memory[k], -1, -1));
+		}
+		old2new[e] = out.size();
+		out.push_back(unroll_entry(instr_memory[e], -1, remainder_start));
+		out.back().instr.label = label;
+		i = e + 1;
+	}
+	old2new[size] = out.size();
+	out.push_back(unroll_entry(instr_memory[size], -1, -1));
+
+	for (map<string, unsigned>::iterator it = labels.begin(); it != labels.end(); it++){
+		if (it->second <= size) new_labels[it->first] = old2new[it->second];
+	}
+	labels = new_labels;
+
+	// write back the program, resolving the branch offsets
+	for (unsigned k=0; k<out.size(); k++){
+		instruction_t instr = out[k].instr;
+		int target = (out[k].new_target >= 0) ? out[k].new_target : ((out[k].old_target >= 0) ? old2new[out[k].old_target] : -1);
+		if (is_branch(instr.opcode) && target >= 0) instr.immediate = (target - (int)k - 1) << 2;
+		instr_memory[k] = instr;
+	}
+}
+
 /* =============================================================
 
    CODE TO BE COMPLETED
@@ -465,20 +1458,221 @@ void sim_pipe_fp::run(unsigned cycles)
             }
         }
         j++;
+        if ((stats_interval != 0) && ((mClock_Cycles % stats_interval) == 0))
+        {
+            stats.dump(mClock_Cycles);
+        }
+    }
+    if ((stats_interval == 0) || ((mClock_Cycles % stats_interval) != 0))
+    {
+        stats.dump(mClock_Cycles);
     }
 }
 
+/* =============   functional simulation ============== */
+
+unsigned sim_pipe_fp::fast_forward(unsigned instructions){
+	unsigned executed = 0;
+	unsigned &pc = sim_pipe_pipeline_reg[IF].PC;
+	while (executed < instructions){
+		instruction_t &instr = instr_memory[(pc - instr_base_address) / 4];
+		opcode_t opcode = instr.opcode;
+		//ENDLOOP is folded, as at fetch
+		if (opcode == ENDLOOP){
+			if (trace_recorder != NULL) trace_recorder->record(instr, pc, 0, loop_counter > 1);
+			if (loop_counter > 1){
+				loop_counter--;
+				pc = loop_start;
+			}else{
+				loop_counter = 0;
+				pc += 4;
+			}
+			continue;
+		}
+		if (opcode == EOP) break;
+		unsigned npc = pc + 4;
+		//operands, read as in ID (through the rename maps, which are stable while the pipeline is empty)
+		unsigned r1 = (instr.src1 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file[rename_int.map[instr.src1]].regVal : UNDEFINED;
+		unsigned r2 = (instr.src2 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file[rename_int.map[instr.src2]].regVal : UNDEFINED;
+		unsigned r3 = (instr.src3 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file[rename_int.map[instr.src3]].regVal : UNDEFINED;
+		unsigned f1 = (instr.src1 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file_fp[rename_fp.map[instr.src1]].regVal : UNDEFINED;
+		unsigned f2 = (instr.src2 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file_fp[rename_fp.map[instr.src2]].regVal : UNDEFINED;
+		unsigned f3 = (instr.src3 < REGISTER_FILE_SIZE) ? sim_pipe_reg_file_fp[rename_fp.map[instr.src3]].regVal : UNDEFINED;
+		unsigned address = 0;
+		unsigned stride = 4;
+		bool taken = false;
+		if (is_int_alu(opcode)){
+			sim_pipe_reg_file[rename_int.map[instr.dest]].regVal = alu(opcode, r1, r2, instr.immediate, npc);
+		}else if (is_fp_alu(opcode)){
+			sim_pipe_reg_file_fp[rename_fp.map[instr.dest]].regVal = alu(opcode, f1, f2, instr.immediate, npc, f3);
+		}else if (is_branch(opcode)){
+			taken = (alu_compute_cond(opcode, r1) == 1);
+			if (taken) npc = alu(opcode, r1, r2, instr.immediate, npc);
+			address = npc;
+		}else if (opcode == LW || opcode == LWS){
+			address = alu(opcode, r1, r2, instr.immediate, npc);
+			if (address < data_memory_size){
+				if (opcode == LW) sim_pipe_reg_file[rename_int.map[instr.dest]].regVal = char2unsigned(&data_memory[address]);
+				else sim_pipe_reg_file_fp[rename_fp.map[instr.dest]].regVal = char2unsigned(&data_memory[address]);
+			}else cout << "LW out of bound memory" << endl;
+		}else if (opcode == SW || opcode == SWS){
+			//the stored register is src1, the base register src2
+			address = alu(opcode, r2, 0, instr.immediate, npc);
+			if (address < data_memory_size) write_memory(address, (opcode == SW) ? r1 : f1);
+			else cout << "SW(S) out of bound memory" << endl;
+		}else if (is_vector_memory(opcode)){
+			bool store = is_vector_store(opcode);
+			if (instr.src3 < REGISTER_FILE_SIZE) stride = r3;
+			address = alu(opcode, store ? r2 : r1, 0, instr.immediate, npc);
+			for (unsigned k = 0, element = address; k < vector_length; k++, element += stride){
+				if (element + 3 >= data_memory_size) cout << "LV/SV out of bound memory" << endl;
+				else if (store) write_memory(element, sim_pipe_vreg_file[instr.src1].regVal[k]);
+				else sim_pipe_vreg_file[instr.dest].regVal[k] = char2unsigned(&data_memory[element]);
+			}
+		}else if (is_vector_alu(opcode)){
+			opcode_t element_opcode = (opcode == ADDV) ? ADDS : ((opcode == SUBV) ? SUBS : MULTS);
+			for (unsigned k = 0; k < vector_length; k++)
+				sim_pipe_vreg_file[instr.dest].regVal[k] = alu(element_opcode, sim_pipe_vreg_file[instr.src1].regVal[k],
+				                                               sim_pipe_vreg_file[instr.src2].regVal[k], 0, 0);
+		}else if (opcode == LOOP){
+			loop_counter = ((int)r1 > 0) ? r1 : 0;
+			loop_start = npc;
+			loop_buffer_valid = 0;
+			address = r1;
+		}
+		if (trace_recorder != NULL) trace_recorder->record(instr, pc, address, taken);
+		if (dataflow_analysis != NULL) dataflow_analysis->execute(instr, pc, address, stride);
+		pc = npc;
+		executed++;
+	}
+	return executed;
+}
+
+/* copies the given lines of the data memory of "source" */
+static void copy_written_lines(sim_pipe_fp *mSimPipe, sim_pipe_fp *source, const vector<unsigned> &lines){
+	for (unsigned i=0; i<lines.size(); i++){
+		unsigned address = lines[i] * WRITE_TRACKING_LINE;
+		unsigned size = mSimPipe->data_memory_size - address;
+		if (size > WRITE_TRACKING_LINE) size = WRITE_TRACKING_LINE;
+		memcpy(mSimPipe->data_memory + address, source->data_memory + address, size);
+	}
+}
+
+/* forgets the lines written so far (the memory is now equal to the one it was copied from/to) */
+static void clear_written_lines(sim_pipe_fp *mSimPipe){
+	for (unsigned i=0; i<mSimPipe->written_list.size(); i++) mSimPipe->written_lines[mSimPipe->written_list[i]] = 0;
+	mSimPipe->written_list.clear();
+}
+
+void sim_pipe_fp::enable_write_tracking(){
+	written_lines.assign((data_memory_size + WRITE_TRACKING_LINE - 1) / WRITE_TRACKING_LINE, 0);
+	written_list.clear();
+}
+
+void sim_pipe_fp::copy_architectural_state(sim_pipe_fp *source){
+	if (source->data_memory_size != data_memory_size){
+		cout << "ERROR:: cannot copy the state of a simulator with a different data memory size" << endl;
+		exit(-1);
+	}
+	for (unsigned r=0; r<REGISTER_FILE_SIZE; r++){
+		sim_pipe_reg_file[rename_int.map[r]].regVal = source->sim_pipe_reg_file[source->rename_int.map[r]].regVal;
+		sim_pipe_reg_file_fp[rename_fp.map[r]].regVal = source->sim_pipe_reg_file_fp[source->rename_fp.map[r]].regVal;
+	}
+	for (unsigned r=0; r<NUM_VECTOR_REGISTERS; r++)
+		memcpy(sim_pipe_vreg_file[r].regVal, source->sim_pipe_vreg_file[r].regVal, sizeof(sim_pipe_vreg_file[r].regVal));
+	if (!written_lines.empty() && !source->written_lines.empty()){
+		//the memories were equal before the lines flagged on either side were written
+		copy_written_lines(this, source, written_list);
+		copy_written_lines(this, source, source->written_list);
+	} else memcpy(data_memory, source->data_memory, data_memory_size);
+	clear_written_lines(this);
+	clear_written_lines(source);
+	memory_digest = source->memory_digest;
+	memory_digest_valid = source->memory_digest_valid;
+	sim_pipe_pipeline_reg[IF].PC = source->sim_pipe_pipeline_reg[IF].PC;
+	loop_counter = source->loop_counter;
+	loop_start = source->loop_start;
+	loop_buffer_valid = 0;
+}
+
+unsigned sim_pipe_fp::record_trace(const char *filename){
+	trace_recorder = new instr_trace_writer(filename, instr_base_address);
+	unsigned recorded = fast_forward(~0u);
+	//the trace ends with the EOP
+	unsigned pc = sim_pipe_pipeline_reg[IF].PC;
+	trace_recorder->record(instr_memory[(pc - instr_base_address) / 4], pc, 0, false);
+	delete trace_recorder;
+	trace_recorder = NULL;
+	return recorded;
+}
+
+unsigned sim_pipe_fp::analyze_dataflow(){
+	unsigned latency[NUM_OPCODES];
+	for (unsigned op=0; op<NUM_OPCODES; op++){
+		opcode_t opcode = (opcode_t)op;
+		latency[op] = 0;
+		if (opcode == NOP || opcode == EOP || opcode == ENDLOOP) continue;
+		for (unsigned u=0; u<num_units; u++){
+			if (exec_units[u].type == unit_type(opcode)){
+				latency[op] = exec_units[u].latency;
+				break;
+			}
+		}
+		if (is_vector(opcode)) latency[op] += vector_length - 1;
+		if (opcode == LW || opcode == LWS || (is_vector_memory(opcode) && !is_vector_store(opcode))) latency[op] += data_memory_latency;
+		if (latency[op] == 0) latency[op] = 1;
+	}
+	if (dataflow_analysis != NULL) delete dataflow_analysis;
+	dataflow_analysis = new dataflow_analyzer(latency, vector_length);
+	return fast_forward(~0u);
+}
+
+unsigned long long sim_pipe_fp::get_critical_path(){
+	return (dataflow_analysis != NULL) ? dataflow_analysis->critical_path() : 0;
+}
+
+float sim_pipe_fp::get_ideal_IPC(){
+	return (dataflow_analysis != NULL) ? dataflow_analysis->ideal_ipc() : 0.0;
+}
+
+void sim_pipe_fp::replay_trace(const char *filename){
+	if (trace_replay != NULL) delete trace_replay;
+	trace_replay = new instr_trace_reader(filename);
+	if (trace_replay->base_address() != instr_base_address){
+		cout << "ERROR:: trace " << filename << " was recorded with the program at 0x" << hex << trace_replay->base_address() << dec << endl;
+		exit(-1);
+	}
+}
+
+/* identity mapping, all the other physical registers free */
+static void rename_table_reset(renameTable_t *table, unsigned num_physical){
+	for (unsigned i=0; i<REGISTER_FILE_SIZE; i++) table->map[i] = i;
+	table->num_free = 0;
+	for (unsigned i=REGISTER_FILE_SIZE; i<num_physical; i++) table->free_list[table->num_free++] = i;
+	table->num_pending = 0;
+	table->max_in_use = REGISTER_FILE_SIZE;
+}
+
 //reset the state of the sim_pipe_fpulator
 void sim_pipe_fp::reset(){
-	// init data memory
+	// init data memory (the mapped data images, if any, are replaced by an empty memory)
+	if (data_image_mapped) map_anonymous_memory(data_memory, data_memory_mapping_size);
+	data_image_mapped = false;
 	for (unsigned i=0; i<data_memory_size; i++) data_memory[i]=0xFF;
+	memory_digest = 0;
+	memory_digest_valid = true;
 	// init instruction memory
 	for (int i=0; i<PROGRAM_SIZE;i++){
 		instr_memory[i].opcode=(opcode_t)NOP;
 		instr_memory[i].src1=UNDEFINED;
 		instr_memory[i].src2=UNDEFINED;
 		instr_memory[i].dest=UNDEFINED;
+		instr_memory[i].src3=UNDEFINED;
 		instr_memory[i].immediate=UNDEFINED;
+		instr_memory[i].address=UNDEFINED;
+		instr_memory[i].seq=UNDEFINED;
+		instr_memory[i].unit=UNDEFINED;
+		for (int s=0; s<NUM_STAGES; s++) instr_memory[i].exit_cycle[s]=UNDEFINED;
 	}
 
 	/* complete the reset function here */
@@ -487,7 +1681,7 @@ void sim_pipe_fp::reset(){
     /** Reset register file **/
     //sim_pipe_reg_file[0].regVal = 0;
     //sim_pipe_reg_file[0].isDestination = FALSE;
-    for(int i=0;i<REGISTER_FILE_SIZE;i++)
+    for(int i=0;i<MAX_PHYSICAL_REGISTERS;i++)
     {
         sim_pipe_reg_file[i].regVal = UNDEFINED;
         sim_pipe_reg_file[i].isDestination = FALSE;
@@ -495,23 +1689,116 @@ void sim_pipe_fp::reset(){
         sim_pipe_reg_file_fp[i].isDestination = FALSE;
     }
 
-    for(int i=0;i<NUM_STAGES;i++)
-    {
-        sim_pipe_pipeline_reg[i].PC = UNDEFINED;
-        sim_pipe_pipeline_reg[i].NPC = UNDEFINED;
-        sim_pipe_pipeline_reg[i].IR.opcode = NOP;
-        sim_pipe_pipeline_reg[i].Rd = UNDEFINED;
-        sim_pipe_pipeline_reg[i].Imm = UNDEFINED;
-        sim_pipe_pipeline_reg[i].A = UNDEFINED;
-        sim_pipe_pipeline_reg[i].B = UNDEFINED;
-        sim_pipe_pipeline_reg[i].ALU_Output = UNDEFINED;
-        sim_pipe_pipeline_reg[i].Cond = UNDEFINED;
-        sim_pipe_pipeline_reg[i].LMD = UNDEFINED;
-        sim_pipe_pipeline_reg[i].isAvailable = FALSE;
-    }
-    sim_pipe_pipeline_reg[IF].isAvailable = TRUE;
-    /** Added Code End**/
+    for(int i=0;i<NUM_VECTOR_REGISTERS;i++)
+        for(int j=0;j<MAX_VECTOR_LENGTH;j++) sim_pipe_vreg_file[i].regVal[j] = UNDEFINED;
+    vector_length = MAX_VECTOR_LENGTH;
+    vector_chaining = true;
+
+    loop_counter = 0;
+    loop_start = UNDEFINED;
+
+    register_renaming = false;
+    num_physical_registers = REGISTER_FILE_SIZE;
+
+    labels.clear();
+    disable_pipeline_trace();
+    disable_reuse_analysis();
+    if (dataflow_analysis != NULL) delete dataflow_analysis;
+    dataflow_analysis = NULL;
+    if (trace_replay != NULL) delete trace_replay;
+    trace_replay = NULL;
+    written_lines.clear();
+    written_list.clear();
+
+    stats.close();
+    stats.clear();
+    stats_interval = 0;
+    stats_latency_histogram = UNDEFINED;
+    stats_busy_units_histogram = UNDEFINED;
+    workload_profile = false;
+    stats_raw_distance_histogram = UNDEFINED;
+    stats_load_stride_histogram = UNDEFINED;
+    stats_store_stride_histogram = UNDEFINED;
+
+    reset_pipeline();
+}
+
+/* clears the counters of the workload profile */
+static void clear_workload_profile(sim_pipe_fp *mSimPipe){
+	for (unsigned op=0; op<NUM_OPCODES; op++) mSimPipe->mix_counts[op] = mSimPipe->branches_taken[op] = 0;
+	for (unsigned f=0; f<3; f++)
+		for (unsigned r=0; r<REGISTER_FILE_SIZE; r++)
+			for (unsigned w=0; w<WRITER_HISTORY; w++) mSimPipe->last_writers[f][r][w] = UNDEFINED;
+	for (unsigned i=0; i<PROGRAM_SIZE; i++) mSimPipe->last_address[i] = UNDEFINED;
+}
+
+/* empties a pipeline register */
+static void reset_pipeline_reg(pipelineRegVals_t &reg){
+	reg.PC = UNDEFINED;
+	reg.NPC = UNDEFINED;
+	reg.IR.opcode = NOP;
+	reg.Rd = UNDEFINED;
+	reg.Imm = UNDEFINED;
+	reg.A = UNDEFINED;
+	reg.B = UNDEFINED;
+	reg.C = UNDEFINED;
+	reg.ALU_Output = UNDEFINED;
+	reg.Cond = UNDEFINED;
+	reg.LMD = UNDEFINED;
+	reg.isAvailable = FALSE;
+}
+
+void sim_pipe_fp::reset_pipeline(){
+	for (unsigned i=0; i<NUM_STAGES; i++) reset_pipeline_reg(sim_pipe_pipeline_reg[i]);
+	sim_pipe_pipeline_reg[IF].isAvailable = TRUE;
+	for (unsigned i=0; i<num_units; i++){
+		exec_units[i].busy = 0;
+		exec_units[i].instruction.opcode = NOP;
+		reset_pipeline_reg(sim_pipe_pipeline_reg_EXE[i]);
+	}
+	for (unsigned i=0; i<MAX_PHYSICAL_REGISTERS; i++)
+		sim_pipe_reg_file[i].isDestination = sim_pipe_reg_file_fp[i].isDestination = FALSE;
+	for (unsigned i=0; i<NUM_VECTOR_REGISTERS; i++) sim_pipe_vreg_file[i].isDestination = FALSE;
+
+	mInstruction_Count = 0;
+	mClock_Cycles = 0;
+	mStalls_Count = 0;
+	is_memory_ongoing = FALSE;
+	is_branch_ongoing = FALSE;
+	is_branch_calculated = FALSE;
+	mControlDelay = 0;
+	mMemDelay = 0;
+
+	for (unsigned i=0; i<MAX_UNITS; i++) vector_chain_mask[i] = 0;
+	loop_buffer_valid = 0;
+	loop_buffer_hits = 0;
+	replay_loop_count = 0;
+
+	rename_table_reset(&rename_int, num_physical_registers);
+	rename_table_reset(&rename_fp, num_physical_registers);
+	for (unsigned i=0; i<MAX_UNITS; i++) rename_arch_dest[i] = UNDEFINED;
+	rename_waw_eliminated = 0;
+	rename_pool_stalls = 0;
+
+	memset(stall_profile, 0, sizeof(stall_profile));
+	memset(instr_profile, 0, sizeof(instr_profile));
+	fetch_seq = 0;
+
+	stats.reset_histograms();
+	for (unsigned i=0; i<NUM_STALL_CAUSES; i++) stall_counts[i] = 0;
+	for (unsigned i=0; i<MAX_UNITS; i++){
+		unit_issued[i] = unit_busy_cycles[i] = 0;
+		unit_wait_cause[i] = STALL_STRUCTURAL;
+	}
+	memory_loads = 0;
+	memory_stores = 0;
+	memory_busy_cycles = 0;
+	if (workload_profile) clear_workload_profile(this);
+}
 
+void sim_pipe_fp::restart_from(sim_pipe_fp *source){
+	reset_pipeline();
+	copy_architectural_state(source);
 }
 
 //return value of special purpose register
@@ -579,40 +1866,511 @@ unsigned sim_pipe_fp::get_sp_register(sp_register_t reg, stage_t s){
     return mRetVal; //please modify // please modify
 }
 
-int sim_pipe_fp::get_int_register(unsigned reg){
-	return sim_pipe_reg_file[reg].regVal; // please modify
+int sim_pipe_fp::get_int_register(unsigned reg){
+	return sim_pipe_reg_file[rename_int.map[reg]].regVal; // please modify
+}
+
+void sim_pipe_fp::set_int_register(unsigned reg, int value)
+{
+    sim_pipe_reg_file[rename_int.map[reg]].regVal = value;
+}
+
+float sim_pipe_fp::get_fp_register(unsigned reg){
+	return unsigned2float(sim_pipe_reg_file_fp[rename_fp.map[reg]].regVal); // please modify
+}
+
+void sim_pipe_fp::set_fp_register(unsigned reg, float value)
+{
+    sim_pipe_reg_file_fp[rename_fp.map[reg]].regVal = float2unsigned(value);
+}
+
+float sim_pipe_fp::get_vector_register(unsigned reg, unsigned element){
+	return unsigned2float(sim_pipe_vreg_file[reg].regVal[element]);
+}
+
+void sim_pipe_fp::set_vector_register(unsigned reg, unsigned element, float value)
+{
+    sim_pipe_vreg_file[reg].regVal[element] = float2unsigned(value);
+}
+
+void sim_pipe_fp::set_vector_length(unsigned length)
+{
+    if((length == 0) || (length > MAX_VECTOR_LENGTH))
+    {
+        cout << "ERROR:: vector length must be between 1 and " << MAX_VECTOR_LENGTH << endl;
+        exit(-1);
+    }
+    vector_length = length;
+}
+
+void sim_pipe_fp::set_vector_chaining(bool enabled)
+{
+    vector_chaining = enabled;
+}
+
+
+void sim_pipe_fp::enable_register_renaming(unsigned num_physical)
+{
+    if (num_physical <= REGISTER_FILE_SIZE || num_physical > MAX_PHYSICAL_REGISTERS)
+    {
+        cout << "ERROR:: the number of physical registers must be in (" << REGISTER_FILE_SIZE << ", " << MAX_PHYSICAL_REGISTERS << "]" << endl;
+        exit(-1);
+    }
+    //the architectural registers keep their values: they are mapped onto the first physical registers
+    register_renaming = true;
+    num_physical_registers = num_physical;
+    rename_table_reset(&rename_int, num_physical_registers);
+    rename_table_reset(&rename_fp, num_physical_registers);
+}
+
+void sim_pipe_fp::print_renaming_stats()
+{
+    cout << "Register renaming: " << (register_renaming ? "enabled" : "disabled") << ", " << dec << num_physical_registers << " physical registers per file" << endl;
+    cout << "WAW stalls eliminated = " << rename_waw_eliminated << endl;
+    cout << "Stalls on empty free list = " << rename_pool_stalls << endl;
+    cout << "Peak physical registers in use = " << rename_int.max_in_use << " (R) / " << rename_fp.max_in_use << " (F)" << endl;
+}
+
+float sim_pipe_fp::get_IPC(){
+	return ((float)mInstruction_Count/(float)mClock_Cycles); // please modify
+}
+
+unsigned sim_pipe_fp::get_instructions_executed(){
+	return mInstruction_Count; // please modify
+}
+
+unsigned sim_pipe_fp::get_clock_cycles(){
+	return mClock_Cycles; // please modify
+}
+
+unsigned sim_pipe_fp::get_stalls(){
+	return mStalls_Count;//(mClock_Cycles-mInstruction_Count-4); // please modify
+}
+
+unsigned sim_pipe_fp::get_stalls(stall_cause_t cause){
+	return stall_counts[cause];
+}
+
+void sim_pipe_fp::register_stats(){
+	static const char *cause_names[NUM_STALL_CAUSES] = {"raw", "waw", "structural", "mem_port", "control", "memory", "rename"};
+	static const char *cause_descriptions[NUM_STALL_CAUSES] = {"stalls on a source register not yet written", "stalls on a destination still to be written",
+		"stalls with no free execution unit", "stalls with the units waiting for the MEM stage", "stalls on branches",
+		"stalls with the units waiting for the data memory", "stalls with no free physical register"};
+
+	stats.clear();
+	stats.add_counter("sim.cycles", "clock cycles", &mClock_Cycles);
+	stats.add_counter("sim.instructions", "instructions retired", &mInstruction_Count);
+	stats.add_formula("sim.ipc", "instructions per cycle", "sim.instructions", "sim.cycles");
+	stats.add_formula("sim.cpi", "cycles per instruction", "sim.cycles", "sim.instructions");
+	stats.add_counter("fetch.loop_buffer_hits", "instructions fetched from the loop buffer", &loop_buffer_hits);
+	stats.add_counter("pipeline.stalls.total", "stall cycles inserted in ID", &mStalls_Count);
+	for (unsigned c=0; c<NUM_STALL_CAUSES; c++) stats.add_counter(string("pipeline.stalls.") + cause_names[c], cause_descriptions[c], &stall_counts[c]);
+	stats_latency_histogram = stats.add_histogram("pipeline.retire_latency", "fetch-to-retire latency (cycles)", 32, 2);
+	unsigned count[NUM_UNIT_TYPES] = {0};
+	for (unsigned i=0; i<num_units; i++){
+		stringstream name;
+		name << "exec_units." << unit_names[exec_units[i].type] << count[exec_units[i].type]++;
+		stats.add_counter(name.str() + ".issued", "instructions issued to the unit", &unit_issued[i]);
+		stats.add_counter(name.str() + ".busy_cycles", "cycles the unit is busy", &unit_busy_cycles[i]);
+		stats.add_formula(name.str() + ".utilization", "fraction of the cycles the unit is busy", name.str() + ".busy_cycles", "sim.cycles");
+	}
+	stats_busy_units_histogram = stats.add_histogram("exec_units.busy_units", "busy execution units per cycle", num_units + 1);
+	stats.add_counter("memory.loads", "loads (scalar and vector) executed", &memory_loads);
+	stats.add_counter("memory.stores", "stores (scalar and vector) executed", &memory_stores);
+	stats.add_counter("memory.busy_cycles", "cycles waiting for the data memory", &memory_busy_cycles);
+	if (register_renaming){
+		stats.add_counter("rename.waw_eliminated", "WAW stall cycles avoided by renaming", &rename_waw_eliminated);
+		stats.add_counter("rename.pool_stalls", "stalls on an empty free list", &rename_pool_stalls);
+	}
+	stats_raw_distance_histogram = stats_load_stride_histogram = stats_store_stride_histogram = UNDEFINED;
+	if (workload_profile){
+		for (unsigned op=0; op<NUM_OPCODES; op++){
+			if (op == NOP || op == EOP) continue;
+			stats.add_counter(string("mix.") + instr_names[op], "instructions retired", &mix_counts[op]);
+		}
+		for (unsigned op=0; op<NUM_OPCODES; op++){
+			if (!is_branch((opcode_t)op)) continue;
+			stats.add_counter(string("branches.") + instr_names[op] + ".taken", "taken branches", &branches_taken[op]);
+			stats.add_formula(string("branches.") + instr_names[op] + ".taken_rate", "fraction of the branches taken",
+			                  string("branches.") + instr_names[op] + ".taken", string("mix.") + instr_names[op]);
+		}
+		stats_raw_distance_histogram = stats.add_histogram("deps.raw_distance", "instructions between a producer and its consumer", 32);
+		stats_load_stride_histogram = stats.add_histogram("memory.load_stride", "address stride between executions of a load (bytes)", 17, 4);
+		stats_store_stride_histogram = stats.add_histogram("memory.store_stride", "address stride between executions of a store (bytes)", 17, 4);
+	}
+}
+
+void sim_pipe_fp::enable_stats_dump(const char *filename, stats_format_t format, unsigned interval){
+	register_stats();
+	stats.open(filename, format);
+	stats_interval = interval;
+}
+
+void sim_pipe_fp::print_stats(){
+	if (stats_latency_histogram == UNDEFINED) register_stats();
+	stats.print();
+}
+
+void sim_pipe_fp::enable_workload_profile(){
+	workload_profile = true;
+	clear_workload_profile(this);
+	register_stats();
+}
+
+/* prints the non-empty buckets of a histogram of the workload profile */
+static void print_profile_histogram(sim_stats &stats, unsigned histogram, unsigned bucket_size, const char *unit){
+	const vector<unsigned long long> &buckets = stats.buckets(histogram);
+	unsigned long long samples = 0;
+	for (unsigned b=0; b<buckets.size(); b++) samples += buckets[b];
+	for (unsigned b=0; b<buckets.size(); b++){
+		if (buckets[b] == 0) continue;
+		stringstream range;
+		range << b * bucket_size << ((b + 1 == buckets.size()) ? "+" : "") << " " << unit;
+		cout << "  " << left << setw(14) << range.str() << right << setw(10) << buckets[b] << setw(7) << (100.0 * buckets[b] / samples) << "%" << endl;
+	}
+}
+
+void sim_pipe_fp::print_workload_profile(){
+	if (!workload_profile){
+		cout << "ERROR:: the workload profile is not enabled" << endl;
+		exit(-1);
+	}
+	ios::fmtflags flags = cout.flags();
+	streamsize precision = cout.precision();
+	char fill = cout.fill(' ');
+	unsigned long long retired = 0;
+	for (unsigned op=0; op<NUM_OPCODES; op++) retired += mix_counts[op];
+	if (retired == 0) retired = 1;
+
+	cout << "Instruction mix:" << endl << fixed << setprecision(1) << dec;
+	for (unsigned op=0; op<NUM_OPCODES; op++){
+		if (mix_counts[op] == 0) continue;
+		cout << "  " << left << setw(14) << instr_names[op] << right << setw(10) << mix_counts[op] << setw(7) << (100.0 * mix_counts[op] / retired) << "%";
+		if (is_branch((opcode_t)op)) cout << "  taken " << (100.0 * branches_taken[op] / mix_counts[op]) << "%";
+		cout << endl;
+	}
+	cout << "RAW dependency distance:" << endl;
+	print_profile_histogram(stats, stats_raw_distance_histogram, 1, "instr");
+	cout << "Load stride:" << endl;
+	print_profile_histogram(stats, stats_load_stride_histogram, 4, "bytes");
+	cout << "Store stride:" << endl;
+	print_profile_histogram(stats, stats_store_stride_histogram, 4, "bytes");
+	cout.flags(flags);
+	cout.precision(precision);
+	cout.fill(fill);
+}
+
+/* returns the label region of an instruction as "label+offset" */
+static string instruction_location(const map<string, unsigned> &labels, unsigned index){
+	string name = "";
+	unsigned start = 0;
+	for (map<string, unsigned>::const_iterator it = labels.begin(); it != labels.end(); it++){
+		if (it->second <= index && (name == "" || it->second > start)){
+			name = it->first;
+			start = it->second;
+		}
+	}
+	stringstream ss;
+	ss << ((name == "") ? "<entry>" : name);
+	if (index != start) ss << "+" << (index - start);
+	return ss.str();
+}
+
+static bool stall_entry_greater(const pair<unsigned, unsigned> &a, const pair<unsigned, unsigned> &b){
+	return (a.second > b.second) || (a.second == b.second && a.first < b.first);
+}
+
+static bool region_greater(const pair<string, unsigned long long> &a, const pair<string, unsigned long long> &b){
+	return (a.second > b.second) || (a.second == b.second && a.first < b.first);
+}
+
+void sim_pipe_fp::print_hot_spots(float min_percent){
+	ios::fmtflags flags = cout.flags();
+	streamsize precision = cout.precision();
+	char fill = cout.fill(' ');
+
+	// the in-order pipeline issues at most one instruction per cycle: the time spent in ID
+	// (issue and issue stalls) is what each instruction costs
+	unsigned long long total = 0, retired = 0;
+	for (unsigned i=0; i<PROGRAM_SIZE; i++){
+		total += instr_profile[i].stage_cycles[ID];
+		retired += instr_profile[i].retired;
+	}
+	if (total == 0) total = 1;
+
+	// label regions, ranked by cycles
+	map<unsigned, string> names;
+	for (map<string, unsigned>::iterator it = labels.begin(); it != labels.end(); it++) names[it->second] = it->first;
+	map<string, pair<unsigned long long, unsigned long long> > regions; // cycles, retired
+	for (unsigned i=0; i<PROGRAM_SIZE; i++){
+		if (instr_profile[i].retired == 0) continue;
+		string location = instruction_location(labels, i);
+		string region = location.substr(0, location.find('+'));
+		regions[region].first += instr_profile[i].stage_cycles[ID];
+		regions[region].second += instr_profile[i].retired;
+	}
+	vector<pair<string, unsigned long long> > ranked;
+	for (map<string, pair<unsigned long long, unsigned long long> >::iterator it = regions.begin(); it != regions.end(); it++) ranked.push_back(make_pair(it->first, it->second.first));
+	sort(ranked.begin(), ranked.end(), region_greater);
+
+	cout << "Hot spots: " << dec << retired << " instructions retired, " << mClock_Cycles << " clock cycles" << endl;
+	cout << "Region      Cycles%  Retired" << endl;
+	for (unsigned r=0; r<ranked.size(); r++){
+		cout << left << setw(12) << ranked[r].first << right << fixed << setprecision(1) << setw(7) << (100.0 * ranked[r].second / total) << "%"
+		     << setw(9) << regions[ranked[r].first].second << endl;
+	}
+
+	// annotated listing
+	cout << "Cycles%  Retired     ID     EX    MEM     WB  Latency  PC          Instruction" << endl;
+	bool elided = false;
+	for (unsigned i=0; i<PROGRAM_SIZE; i++){
+		unsigned pc = instr_base_address + 4 * i;
+		if (names.count(i)) cout << names[i] << ":" << endl;
+		if (instr_memory[i].opcode == EOP){
+			cout << setw(55) << "" << "0x" << hex << setw(8) << setfill('0') << pc << setfill(' ') << dec << "  EOP" << endl;
+			break;
+		}
+		instrProfileEntry_t &entry = instr_profile[i];
+		float share = 100.0 * entry.stage_cycles[ID] / total;
+		if (share < min_percent){
+			if (!elided) cout << "   ..." << endl;
+			elided = true;
+			continue;
+		}
+		elided = false;
+		if (entry.retired == 0){
+			cout << setw(55) << "";
+		}else{
+			cout << setw(6) << share << "% " << setw(8) << entry.retired;
+			for (unsigned s=ID; s<NUM_STAGES; s++) cout << setw(7) << ((double)entry.stage_cycles[s] / entry.retired);
+			cout << setw(9) << ((double)entry.latency / entry.retired) << "  ";
+		}
+		cout << "0x" << hex << setw(8) << setfill('0') << pc << setfill(' ') << dec << "  " << instruction_text(instr_memory[i]) << endl;
+	}
+
+	cout.flags(flags);
+	cout.precision(precision);
+	cout.fill(fill);
 }
 
-void sim_pipe_fp::set_int_register(unsigned reg, int value)
-{
-    sim_pipe_reg_file[reg].regVal = value;
+void sim_pipe_fp::print_stall_profile(){
+	static const char *cause_names[NUM_STALL_CAUSES] = {"RAW", "WAW", "STRUCTURAL", "MEM_PORT", "CONTROL", "MEMORY", "RENAME"};
+
+	ios::fmtflags flags = cout.flags();
+	char fill = cout.fill(' ');
+	cout << "Stall profile: " << dec << mStalls_Count << " stall cycles" << endl;
+	for (unsigned c=0; c<NUM_STALL_CAUSES; c++) cout << "  " << left << setw(12) << cause_names[c] << right << get_stalls((stall_cause_t)c) << endl;
+
+	// instructions ranked by stall cycles
+	vector<pair<unsigned, unsigned> > ranked;
+	for (unsigned i=0; i<PROGRAM_SIZE; i++){
+		unsigned total = 0;
+		for (unsigned c=0; c<NUM_STALL_CAUSES; c++) total += stall_profile[i].cycles[c];
+		if (total > 0) ranked.push_back(make_pair(instr_base_address + 4 * i, total));
+	}
+	sort(ranked.begin(), ranked.end(), stall_entry_greater);
+	cout << "Rank  PC          Location    Instruction             Stalls  Breakdown" << endl;
+	for (unsigned r=0; r<ranked.size(); r++){
+		unsigned pc = ranked[r].first;
+		unsigned index = (pc - instr_base_address) / 4;
+		stallProfileEntry_t &entry = stall_profile[index];
+		cout << left << setw(6) << dec << (r + 1) << "0x" << hex << setw(8) << setfill('0') << right << pc << setfill(' ') << "  " << left
+		     << setw(12) << instruction_location(labels, index) << setw(24) << ((index < PROGRAM_SIZE) ? instruction_text(instr_memory[index]) : string("?"))
+		     << right << setw(6) << dec << ranked[r].second << " ";
+		for (unsigned c=0; c<NUM_STALL_CAUSES; c++){
+			if (entry.cycles[c] == 0) continue;
+			cout << " " << cause_names[c] << " " << entry.cycles[c];
+			if (c != STALL_RAW) continue;
+			// source registers as written in the program (with renaming the pipeline holds physical ones)
+			map<string, unsigned> raw_registers;
+			unsigned sources[3] = {instr_memory[index].src1, instr_memory[index].src2, instr_memory[index].src3};
+			for (unsigned f=1; f<=3; f++){
+				if (entry.raw_operands[f-1] == 0) continue;
+				stringstream ss;
+				ss << operand_class(instr_memory[index].opcode, f) << sources[f-1];
+				raw_registers[ss.str()] += entry.raw_operands[f-1];
+			}
+			if (!raw_registers.empty()){
+				cout << " (";
+				for (map<string, unsigned>::iterator it = raw_registers.begin(); it != raw_registers.end(); it++){
+					cout << ((it == raw_registers.begin()) ? "" : ", ") << it->first << " " << it->second;
+				}
+				cout << ")";
+			}
+		}
+		cout << endl;
+	}
+	cout.flags(flags);
+	cout.fill(fill);
 }
 
-float sim_pipe_fp::get_fp_register(unsigned reg){
-	return unsigned2float(sim_pipe_reg_file_fp[reg].regVal); // please modify
+void sim_pipe_fp::print_dataflow_analysis(unsigned max_instructions){
+	if (dataflow_analysis == NULL){
+		cout << "ERROR:: no dataflow analysis was made" << endl;
+		exit(-1);
+	}
+	ios::fmtflags flags = cout.flags();
+	char fill = cout.fill(' ');
+	unsigned long long length = dataflow_analysis->critical_path();
+	cout << "Dataflow limit: " << dec << dataflow_analysis->instructions() << " instructions, critical path = " << length
+	     << " clock cycles, ideal IPC = " << dataflow_analysis->ideal_ipc() << endl;
+
+	// static instructions ranked by their dynamic instances on the critical path
+	map<unsigned, unsigned long long> instances = dataflow_analysis->critical_instructions();
+	unsigned long long on_path = 0;
+	vector<pair<unsigned, unsigned> > ranked;
+	for (map<unsigned, unsigned long long>::iterator it = instances.begin(); it != instances.end(); it++){
+		ranked.push_back(make_pair(it->first, (unsigned)it->second));
+		on_path += it->second;
+	}
+	sort(ranked.begin(), ranked.end(), stall_entry_greater);
+	cout << "Critical path: " << on_path << " instructions" << endl;
+	cout << "Rank  PC          Location    Instruction          Instances" << endl;
+	for (unsigned r=0; r<ranked.size() && r<max_instructions; r++){
+		unsigned pc = ranked[r].first;
+		unsigned index = (pc - instr_base_address) / 4;
+		cout << left << setw(6) << dec << (r + 1) << "0x" << hex << setw(8) << setfill('0') << right << pc << setfill(' ') << "  " << left
+		     << setw(12) << instruction_location(labels, index) << setw(24) << ((index < PROGRAM_SIZE) ? instruction_text(instr_memory[index]) : string("?"))
+		     << right << setw(6) << dec << ranked[r].second << endl;
+	}
+	cout.flags(flags);
+	cout.fill(fill);
 }
+/* ======================== pipeline trace ==================================== */
+
+#define TRACE_BUFFER_SIZE (1 << 20)
+#define TRACE_TICKS_PER_CYCLE 1000
+
+/* O3PipeView records, buffered in memory and written with fwrite. Instructions retire out of
+   order (units have different latencies): records are held until all the older ones are out */
+class pipe_trace_writer{
+public:
+	pipe_trace_writer(FILE *file) : file(file), used(0), next_seq(0) { buffer = new char[TRACE_BUFFER_SIZE]; }
+	~pipe_trace_writer(){ flush(); fclose(file); delete [] buffer; }
+
+	void retire(const instruction_t &instr, exe_unit_t unit){
+		pending[instr.seq] = make_pair(instr, unit);
+		while (!pending.empty() && pending.begin()->first == next_seq){
+			write_record(pending.begin()->second.first, pending.begin()->second.second);
+			pending.erase(pending.begin());
+			next_seq++;
+		}
+	}
 
-void sim_pipe_fp::set_fp_register(unsigned reg, float value)
-{
-    sim_pipe_reg_file_fp[reg].regVal = float2unsigned(value);
+	void flush(){
+		//records still waiting for an older instruction (e.g. the run stopped mid-program)
+		for (map<unsigned, pair<instruction_t, exe_unit_t> >::iterator it = pending.begin(); it != pending.end(); it++) write_record(it->second.first, it->second.second);
+		pending.clear();
+		if (used) fwrite(buffer, 1, used, file);
+		used = 0;
+	}
+
+private:
+	FILE *file;
+	char *buffer;
+	unsigned used;
+	unsigned next_seq;
+	map<unsigned, pair<instruction_t, exe_unit_t> > pending;
+
+	void write_record(const instruction_t &instr, exe_unit_t unit){
+		string text = instruction_text(instr);
+		unsigned long long fetch = (unsigned long long)instr.exit_cycle[IF] * TRACE_TICKS_PER_CYCLE;
+		unsigned long long decode = fetch + TRACE_TICKS_PER_CYCLE;
+		unsigned long long dispatch = (unsigned long long)instr.exit_cycle[ID] * TRACE_TICKS_PER_CYCLE;
+		unsigned long long issue = dispatch + TRACE_TICKS_PER_CYCLE;
+		unsigned long long complete = (unsigned long long)instr.exit_cycle[EXE] * TRACE_TICKS_PER_CYCLE;
+		unsigned long long retire = (unsigned long long)instr.exit_cycle[WB] * TRACE_TICKS_PER_CYCLE;
+		unsigned long long store = (instr.opcode == SW || instr.opcode == SWS || is_vector_store(instr.opcode)) ?
+		                           (unsigned long long)instr.exit_cycle[MEM] * TRACE_TICKS_PER_CYCLE : 0;
+		while (true){
+			int length = snprintf(buffer + used, TRACE_BUFFER_SIZE - used,
+			                      "O3PipeView:fetch:%llu:0x%08x:0:%u:%s (%s)\n"
+			                      "O3PipeView:decode:%llu\nO3PipeView:rename:%llu\nO3PipeView:dispatch:%llu\n"
+			                      "O3PipeView:issue:%llu\nO3PipeView:complete:%llu\nO3PipeView:retire:%llu:store:%llu\n",
+			                      fetch, instr.address, instr.seq + 1, text.c_str(), unit_names[unit],
+			                      decode, decode, dispatch, issue, complete, retire, store);
+			if (length >= 0 && (unsigned)length < TRACE_BUFFER_SIZE - used){
+				used += length;
+				return;
+			}
+			//truncated record: write out the buffer and format the record again at its start
+			if (used == 0){
+				cout << "ERROR:: pipeline trace record larger than the trace buffer" << endl;
+				exit(-1);
+			}
+			fwrite(buffer, 1, used, file);
+			used = 0;
+		}
+	}
+};
+
+void sim_pipe_fp::enable_pipeline_trace(const char *filename){
+	disable_pipeline_trace();
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open trace file " << filename << endl;
+		exit(-1);
+	}
+	pipeline_trace = new pipe_trace_writer(file);
 }
 
+void sim_pipe_fp::disable_pipeline_trace(){
+	if (pipeline_trace != NULL) delete pipeline_trace;
+	pipeline_trace = NULL;
+}
 
-float sim_pipe_fp::get_IPC(){
-	return ((float)mInstruction_Count/(float)mClock_Cycles); // please modify
+void sim_pipe_fp::enable_reuse_analysis(unsigned line_size, unsigned max_ways, unsigned max_sets){
+	disable_reuse_analysis();
+	reuse_analysis = new reuse_analyzer(line_size, max_ways, max_sets);
 }
 
-unsigned sim_pipe_fp::get_instructions_executed(){
-	return mInstruction_Count; // please modify
+void sim_pipe_fp::print_reuse_analysis(){
+	if (reuse_analysis == NULL){
+		cout << "ERROR:: the stack-distance analysis is not enabled" << endl;
+		exit(-1);
+	}
+	reuse_analysis->print();
 }
 
-unsigned sim_pipe_fp::get_clock_cycles(){
-	return mClock_Cycles; // please modify
+void sim_pipe_fp::disable_reuse_analysis(){
+	if (reuse_analysis != NULL) delete reuse_analysis;
+	reuse_analysis = NULL;
 }
 
-unsigned sim_pipe_fp::get_stalls(){
-	return mStalls_Count;//(mClock_Cycles-mInstruction_Count-4); // please modify
+/* trace replay: fetches the next instruction of the trace, whose PC replaces the one computed by the
+   pipeline; ENDLOOP records are folded as at fetch, following the recorded outcome */
+static instruction_t replay_fetch(sim_pipe_fp* mSimPipe)
+{
+    trace_record_t record;
+    while (mSimPipe->trace_replay->next(record))
+    {
+        if (record.opcode == ENDLOOP)
+        {
+            mSimPipe->fetch_instruction(record.pc);
+            if (record.taken) mSimPipe->loop_counter--;
+            else mSimPipe->loop_counter = 0;
+            continue;
+        }
+        if (record.opcode == LOOP) mSimPipe->replay_loop_count = record.value;
+        if (mSimPipe->workload_profile)
+        {
+            //the workload profile takes branch outcomes and addresses from the trace
+            if (is_branch((opcode_t)record.opcode) && record.taken) mSimPipe->branches_taken[record.opcode]++;
+            if (is_memory((opcode_t)record.opcode)) profile_memory_access(mSimPipe, (opcode_t)record.opcode, record.pc, record.value);
+        }
+        mSimPipe->sim_pipe_pipeline_reg[IF].PC = record.pc;
+        return mSimPipe->fetch_instruction(record.pc);
+    }
+    //the trace has ended with the EOP, which stays in IF
+    instruction_t tempInstr = mSimPipe->fetch_instruction(mSimPipe->sim_pipe_pipeline_reg[IF].PC);
+    if (tempInstr.opcode != EOP)
+    {
+        cout << "ERROR:: truncated instruction trace" << endl;
+        exit(-1);
+    }
+    return tempInstr;
 }
+
 void pipe_IF_Handler(sim_pipe_fp* mSimPipe)
 {
     //TODO: Recheck this implementation
@@ -620,12 +2378,39 @@ void pipe_IF_Handler(sim_pipe_fp* mSimPipe)
     {
         /*
         if ((is_branch(mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode)) &&
-            (mSimPipe->sim_pipe_pipeline_reg[MEM].Cond == 1)&& (is_branch_calculated==TRUE))
+            (mSimPipe->sim_pipe_pipeline_reg[MEM].Cond == 1)&& (mSimPipe->is_branch_calculated==TRUE))
         {
             mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = 0;
             mSimPipe->sim_pipe_pipeline_reg[IF].PC = mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output;
         }*/
-        mSimPipe->sim_pipe_pipeline_reg[ID].IR = mSimPipe->instr_memory[(mSimPipe->sim_pipe_pipeline_reg[IF].PC - mSimPipe->instr_base_address) / 4];
+        instruction_t tempInstr = (mSimPipe->trace_replay != NULL) ? replay_fetch(mSimPipe) :
+                                  mSimPipe->fetch_instruction(mSimPipe->sim_pipe_pipeline_reg[IF].PC);
+        //ENDLOOP is folded at fetch: it never enters the pipeline and costs no cycle
+        while (tempInstr.opcode == ENDLOOP)
+        {
+            if (mSimPipe->loop_counter > 1)
+            {
+                mSimPipe->loop_counter--;
+                mSimPipe->sim_pipe_pipeline_reg[IF].PC = mSimPipe->loop_start;
+            } else
+            {
+                mSimPipe->loop_counter = 0;
+                mSimPipe->sim_pipe_pipeline_reg[IF].PC += 4;
+            }
+            tempInstr = mSimPipe->fetch_instruction(mSimPipe->sim_pipe_pipeline_reg[IF].PC);
+        }
+        if (tempInstr.opcode != EOP)
+        {
+            tempInstr.address = mSimPipe->sim_pipe_pipeline_reg[IF].PC;
+            tempInstr.seq = mSimPipe->fetch_seq++;
+            tempInstr.exit_cycle[IF] = mSimPipe->mClock_Cycles;
+        }
+        if (mSimPipe->register_renaming)
+        {
+            //the instruction in ID (if any) has just issued: the map is up to date
+            rename_sources(mSimPipe, &tempInstr);
+        }
+        mSimPipe->sim_pipe_pipeline_reg[ID].IR = tempInstr;
         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = TRUE;
 
         if ((mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode != EOP))
@@ -643,10 +2428,11 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
     unsigned SW_Swap;
     unsigned tempSrc1;
     unsigned tempSrc2;
+    unsigned tempSrc3;
     unsigned tempDest;
     unsigned tempUnit = UNDEFINED;
+    unsigned tempChainMask = 0;
     opcode_t  tempOpCode;
-    static unsigned mControlDelay=0;
 
     tempOpCode = mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode;
 
@@ -678,15 +2464,28 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
     {
         tempSrc1 = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src1;
         tempSrc2 = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src2;
+        tempSrc3 = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src3;
         tempDest = mSimPipe->sim_pipe_pipeline_reg[ID].IR.dest;
-        if ((tempOpCode == JUMP) || (tempSrc1 < REGISTER_FILE_SIZE) || (tempSrc2 < REGISTER_FILE_SIZE))
+        if ((tempOpCode == JUMP) || (tempSrc1 < MAX_PHYSICAL_REGISTERS) || (tempSrc2 < MAX_PHYSICAL_REGISTERS))
         {
             /*Check any RAW hazards if not NOP and EOP instruction*/
             unsigned isRAWPresent = FALSE;
             unsigned isWAWPresent = FALSE;
-            if(tempSrc1 < REGISTER_FILE_SIZE)
+            if(is_vector(tempOpCode))
+            {
+                vector_hazard_check(mSimPipe, &isRAWPresent, &isWAWPresent, &tempChainMask);
+            }
+            if(!is_vector(tempOpCode) && (tempSrc1 < MAX_PHYSICAL_REGISTERS))
             {
-                if(is_memory(tempOpCode))
+                if(tempOpCode == SWS)
+                {
+                    //SWS src1 is the FP value to be stored
+                    if (mSimPipe->sim_pipe_reg_file_fp[tempSrc1].isDestination == TRUE)
+                    {
+                        isRAWPresent = TRUE;
+                    }
+                }
+                else if(is_memory(tempOpCode))
                 {
                     if (mSimPipe->sim_pipe_reg_file[tempSrc1].isDestination == TRUE)
                     {
@@ -708,9 +2507,9 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
                     }
                 }
             }
-            if(tempSrc2 < REGISTER_FILE_SIZE)
+            if(!is_vector(tempOpCode) && (tempSrc2 < MAX_PHYSICAL_REGISTERS))
             {
-                if (isOpCodeFpType(tempOpCode) == TRUE)
+                if ((isOpCodeFpType(tempOpCode) == TRUE) && (tempOpCode != SWS))
                 {
                     if (mSimPipe->sim_pipe_reg_file_fp[tempSrc2].isDestination == TRUE)
                     {
@@ -725,13 +2524,40 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
                 }
             }
 
-            if(tempDest < REGISTER_FILE_SIZE)
+            if((tempOpCode == FMADDS) && (tempSrc3 < MAX_PHYSICAL_REGISTERS))
+            {
+                //FMADDS addend
+                if (mSimPipe->sim_pipe_reg_file_fp[tempSrc3].isDestination == TRUE)
+                {
+                    isRAWPresent = TRUE;
+                }
+            }
+            unsigned isPoolEmpty = FALSE;
+            unsigned tempWAWCycles = 0;
+            if(mSimPipe->register_renaming && (rename_dest_table(mSimPipe, tempOpCode) != NULL))
+            {
+                //WAW hazards disappear: only count the stall cycles the architectural check would have inserted
+                for(unsigned i=0;i<mSimPipe->num_units;i++)
+                {
+                    if((mSimPipe->rename_arch_dest[i] == tempDest) && (mSimPipe->exec_units[i].busy >= mSimPipe->exec_units[tempUnit].latency) &&
+                       (rename_dest_table(mSimPipe, mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode) == rename_dest_table(mSimPipe, tempOpCode)))
+                    {
+                        temp = mSimPipe->exec_units[i].busy - mSimPipe->exec_units[tempUnit].latency + 1;
+                        if (temp > tempWAWCycles) tempWAWCycles = temp;
+                    }
+                }
+                if(rename_dest_table(mSimPipe, tempOpCode)->num_free == 0)
+                {
+                    isPoolEmpty = TRUE;
+                }
+            }
+            else if(!is_vector(tempOpCode) && (tempDest < MAX_PHYSICAL_REGISTERS))
             {
                 unsigned tempExeDest;
                 for(int i=0;i<mSimPipe->num_units;i++)
                 {
                     tempExeDest = mSimPipe->sim_pipe_pipeline_reg_EXE[i].Rd;
-                    if(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode!= NOP && tempExeDest < REGISTER_FILE_SIZE) {
+                    if(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode!= NOP && !is_vector(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode) && tempExeDest < MAX_PHYSICAL_REGISTERS) {
                         if (tempExeDest == tempDest) {
                             if (mSimPipe->exec_units[i].busy >= mSimPipe->exec_units[tempUnit].latency) {
                                 isWAWPresent = TRUE;
@@ -743,7 +2569,7 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
             if (isRAWPresent == TRUE)
             {
                 /*RAW - issue stall*/
-                mStalls_Count++;
+                record_stall(mSimPipe, STALL_RAW);
                 // mSimPipe->sim_pipe_pipeline_reg[EXE].IR.opcode = NOP;
                 mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                 mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
@@ -751,20 +2577,28 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
             }else if (isWAWPresent == TRUE)
             {
                 /*RAW - issue stall*/
-                mStalls_Count++;
+                record_stall(mSimPipe, STALL_WAW);
                 // mSimPipe->sim_pipe_pipeline_reg[EXE].IR.opcode = NOP;
                 mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                 mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
                 //  mSimPipe->sim_pipe_pipeline_reg[EXE].isAvailable = TRUE;
+            }else if (isPoolEmpty == TRUE)
+            {
+                /*no free physical register - issue stall*/
+                record_stall(mSimPipe, STALL_RENAME);
+                mSimPipe->rename_pool_stalls++;
+                mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
+                mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
             } else
             {
+                mSimPipe->rename_waw_eliminated += tempWAWCycles;
                 mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = TRUE;
                 if (is_branch(mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode))
                 {
                     //TODO: remove the redundant check
                     //Check if all EXE units are done with processing before scheduling branch instr
                     unsigned areAllExeUnitsProcessed = TRUE;
-                    if(mControlDelay == 0)
+                    if(mSimPipe->mControlDelay == 0)
                     {
                         for (int i = 0; i < mSimPipe->num_units; i++)
                         {
@@ -776,32 +2610,32 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
                     }
                     if(areAllExeUnitsProcessed == TRUE)
                     {
-                        mControlDelay++;
-                        if (mControlDelay == 1)
+                        mSimPipe->mControlDelay++;
+                        if (mSimPipe->mControlDelay == 1)
                         {
-                            mStalls_Count++;
+                            record_stall(mSimPipe, STALL_CONTROL);
                             mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
-                            is_branch_ongoing = TRUE;
-                            is_branch_calculated = FALSE;
+                            mSimPipe->is_branch_ongoing = TRUE;
+                            mSimPipe->is_branch_calculated = FALSE;
 
-                        } else if (is_branch_calculated == TRUE)
+                        } else if (mSimPipe->is_branch_calculated == TRUE)
                         {
-                            mControlDelay = 0;
-                            //mStalls_Count++;
+                            mSimPipe->mControlDelay = 0;
+                            //mSimPipe->mStalls_Count++;
                             mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                             mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = TRUE;
-                            is_branch_ongoing = FALSE;
-                            is_branch_calculated = FALSE;
+                            mSimPipe->is_branch_ongoing = FALSE;
+                            mSimPipe->is_branch_calculated = FALSE;
                         } else
                         {
-                            mStalls_Count++;
+                            record_stall(mSimPipe, STALL_CONTROL);
                             mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                             mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
                         }
                     } else
                     {
                         //Branch instr is stalled because other exe units have to complete execution before branch
-                        mStalls_Count++;
+                        record_stall(mSimPipe, STALL_CONTROL);
                         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
                         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
                     }
@@ -818,7 +2652,7 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
 
     }else if((tempOpCode != NOP) && (tempOpCode != EOP))
     {
-        mStalls_Count++;
+        record_stall(mSimPipe, structural_stall_cause(mSimPipe, tempOpCode));
         //Required Exe unit is not available do nothing in ID and don't fetch next instr
         mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable = FALSE;
         mSimPipe->sim_pipe_pipeline_reg[IF].isAvailable = FALSE;
@@ -835,6 +2669,25 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
     }*/
     if(mSimPipe->sim_pipe_pipeline_reg[ID].isAvailable == TRUE)
     {
+        mSimPipe->sim_pipe_pipeline_reg[ID].IR.exit_cycle[ID] = mSimPipe->mClock_Cycles;
+        mSimPipe->sim_pipe_pipeline_reg[ID].IR.unit = tempUnit;
+        mSimPipe->unit_issued[tempUnit]++;
+        if(mSimPipe->register_renaming)
+        {
+            //allocate a new physical destination; the old one is released once its producer has written back
+            renameTable_t *tempTable = rename_dest_table(mSimPipe, tempOpCode);
+            mSimPipe->rename_arch_dest[tempUnit] = UNDEFINED;
+            if(tempTable != NULL)
+            {
+                tempDest = mSimPipe->sim_pipe_pipeline_reg[ID].IR.dest;
+                mSimPipe->rename_arch_dest[tempUnit] = tempDest;
+                tempTable->pending_free[tempTable->num_pending++] = tempTable->map[tempDest];
+                tempTable->map[tempDest] = tempTable->free_list[--tempTable->num_free];
+                mSimPipe->sim_pipe_pipeline_reg[ID].IR.dest = tempTable->map[tempDest];
+                temp = mSimPipe->num_physical_registers - tempTable->num_free;
+                if (temp > tempTable->max_in_use) tempTable->max_in_use = temp;
+            }
+        }
         if((tempOpCode == SW) || (tempOpCode == SWS))
         {
             SW_Swap = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src1;
@@ -846,7 +2699,7 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
         mSimPipe->exec_units[tempUnit].busy = mSimPipe->exec_units[tempUnit].latency;
         //mSimPipe->sim_pipe_pipeline_reg[EXE].IR = mSimPipe->sim_pipe_pipeline_reg[ID].IR;
         temp = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src1;
-        if(temp < REGISTER_FILE_SIZE)
+        if(temp < MAX_PHYSICAL_REGISTERS)
         {
             if(is_memory(tempOpCode))
             {
@@ -864,7 +2717,7 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
             mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].A =UNDEFINED;
         }
         temp = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src2;
-        if(temp < REGISTER_FILE_SIZE)
+        if(temp < MAX_PHYSICAL_REGISTERS)
         {
             if(isOpCodeFpType(tempOpCode) == TRUE)
             {
@@ -879,6 +2732,15 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
             mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].B =UNDEFINED;
         }
 
+        temp = mSimPipe->sim_pipe_pipeline_reg[ID].IR.src3;
+        if((tempOpCode == FMADDS) && (temp < MAX_PHYSICAL_REGISTERS))
+        {
+            mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].C = mSimPipe->sim_pipe_reg_file_fp[temp].regVal;
+        }else
+        {
+            mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].C = UNDEFINED;
+        }
+
         if(is_int_imm(tempOpCode) || is_branch(tempOpCode) || is_memory(tempOpCode))
         {
             mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].Imm = mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].IR.immediate;
@@ -887,11 +2749,14 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
             mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].Imm = UNDEFINED;
         }
         temp = mSimPipe->sim_pipe_pipeline_reg[ID].IR.dest;
-        if(temp < REGISTER_FILE_SIZE)
+        if(temp < MAX_PHYSICAL_REGISTERS)
         {
             //once inside this IF => has a destination
             mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].Rd = temp;
-            if(isOpCodeFpType(tempOpCode))
+            if(is_vector(tempOpCode))
+            {
+                mSimPipe->sim_pipe_vreg_file[temp].isDestination = TRUE;
+            }else if(isOpCodeFpType(tempOpCode))
             {
                 mSimPipe->sim_pipe_reg_file_fp[temp].isDestination = TRUE;
             }else
@@ -905,6 +2770,32 @@ void pipe_ID_Handler(sim_pipe_fp* mSimPipe)
         }
 
         mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].NPC = mSimPipe->sim_pipe_pipeline_reg[ID].NPC;
+        if(is_vector(tempOpCode))
+        {
+            //vector instructions: A = base address, B = stride in bytes, the unit stays busy for the whole vector
+            instruction_t tempIR = mSimPipe->sim_pipe_pipeline_reg[ID].IR;
+            if(is_vector_memory(tempOpCode))
+            {
+                temp = is_vector_store(tempOpCode) ? tempIR.src2 : tempIR.src1;
+                mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].A = mSimPipe->sim_pipe_reg_file[temp].regVal;
+                mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].B = (tempIR.src3 < MAX_PHYSICAL_REGISTERS) ? mSimPipe->sim_pipe_reg_file[tempIR.src3].regVal : 4;
+            }else
+            {
+                mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].A = UNDEFINED;
+                mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].B = UNDEFINED;
+            }
+            mSimPipe->exec_units[tempUnit].busy = mSimPipe->exec_units[tempUnit].latency + mSimPipe->vector_length - 1;
+            mSimPipe->vector_chain_mask[tempUnit] = tempChainMask;
+        }
+        if(tempOpCode == LOOP)
+        {
+            //load the loop counter; the body starts right after the LOOP instruction
+            int tempCount = (mSimPipe->trace_replay != NULL) ? (int)mSimPipe->replay_loop_count :
+                                                                (int)mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].A;
+            mSimPipe->loop_counter = (tempCount > 0) ? tempCount : 0;
+            mSimPipe->loop_start = mSimPipe->sim_pipe_pipeline_reg[ID].NPC;
+            mSimPipe->loop_buffer_valid = 0;
+        }
         //mSimPipe->sim_pipe_pipeline_reg[ID].IR.opcode = NOP;
         mSimPipe->sim_pipe_pipeline_reg_EXE[tempUnit].isAvailable = TRUE;
 
@@ -915,8 +2806,11 @@ void pipe_EXE_Handler(sim_pipe_fp* mSimPipe)
 {
     if(mSimPipe->sim_pipe_pipeline_reg[EXE].IR.opcode != EOP)
     {
+        unsigned tempBusyUnits = 0;
         for (int i = mSimPipe->num_units-1; i >=0; i--) {
             if (mSimPipe->exec_units[i].busy != 0) {
+                mSimPipe->unit_busy_cycles[i]++;
+                tempBusyUnits++;
                 mSimPipe->exec_units[i].busy--;
             }
             if ((mSimPipe->exec_units[i].busy == 0) && (mSimPipe->sim_pipe_pipeline_reg_EXE[i].isAvailable == TRUE) &&
@@ -927,7 +2821,7 @@ void pipe_EXE_Handler(sim_pipe_fp* mSimPipe)
                 opcode_t tempOpCode;
                 temp = mSimPipe->sim_pipe_pipeline_reg_EXE[i].Rd;
                 tempOpCode = mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode;
-                if (temp < REGISTER_FILE_SIZE) {
+                if (temp < MAX_PHYSICAL_REGISTERS) {
                     if ((is_int_alu(tempOpCode)) || (tempOpCode == LW)) {
                         mSimPipe->sim_pipe_reg_file[temp].isDestination = TRUE;
                     } else if ((is_fp_alu(tempOpCode)) || (tempOpCode == LWS)) {
@@ -936,29 +2830,52 @@ void pipe_EXE_Handler(sim_pipe_fp* mSimPipe)
                 } else {
                     //TODO: Error handling
                 }
-                if ((is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == FALSE))
+                if ((mSimPipe->is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == FALSE) &&
+                    (vector_chain_pending(mSimPipe, i) == FALSE))
                 {
                     //If mem stage is free transfer the instr from exe to mem and mark mem as busy
                     mSimPipe->sim_pipe_pipeline_reg[MEM].IR = mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR;
-                    mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output = alu(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode,
+                    mSimPipe->sim_pipe_pipeline_reg[MEM].IR.exit_cycle[EXE] = mSimPipe->mClock_Cycles;
+                    if (mSimPipe->trace_replay != NULL) {
+                        //trace replay: no value is computed, the instruction stream comes from the trace
+                        mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output = UNDEFINED;
+                        mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = UNDEFINED;
+                    } else {
+                        mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output = alu(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode,
                                                                               mSimPipe->sim_pipe_pipeline_reg_EXE[i].A,
                                                                               mSimPipe->sim_pipe_pipeline_reg_EXE[i].B,
                                                                                mSimPipe->sim_pipe_pipeline_reg_EXE[i].Imm,
-                                                                              mSimPipe->sim_pipe_pipeline_reg_EXE[i].NPC);
-                    if (is_branch(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode)) {
-                        mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = alu_compute_cond(
-                                mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode,
-                                mSimPipe->sim_pipe_pipeline_reg_EXE[i].A);
-                    } else {
-                        mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = UNDEFINED;
+                                                                              mSimPipe->sim_pipe_pipeline_reg_EXE[i].NPC,
+                                                                              mSimPipe->sim_pipe_pipeline_reg_EXE[i].C);
+                        if (is_branch(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode)) {
+                            mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = alu_compute_cond(
+                                    mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode,
+                                    mSimPipe->sim_pipe_pipeline_reg_EXE[i].A);
+                        } else {
+                            mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = UNDEFINED;
+                        }
                     }
                     mSimPipe->sim_pipe_pipeline_reg[MEM].B = mSimPipe->sim_pipe_pipeline_reg_EXE[i].B;
                     mSimPipe->sim_pipe_pipeline_reg[MEM].Rd = mSimPipe->sim_pipe_pipeline_reg_EXE[i].Rd;
+                    if (is_vector(tempOpCode)) {
+                        //vector sources are read when the unit completes (chained sources are written back by now)
+                        instruction_t tempIR = mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR;
+                        for (unsigned k = 0; (mSimPipe->trace_replay == NULL) && (k < mSimPipe->vector_length); k++) {
+                            if (is_vector_store(tempOpCode)) {
+                                mSimPipe->vector_pipeline_reg[MEM][k] = mSimPipe->sim_pipe_vreg_file[tempIR.src1].regVal[k];
+                            } else if (is_vector_alu(tempOpCode)) {
+                                mSimPipe->vector_pipeline_reg[MEM][k] = alu((tempOpCode == ADDV) ? ADDS : ((tempOpCode == SUBV) ? SUBS : MULTS),
+                                                                            mSimPipe->sim_pipe_vreg_file[tempIR.src1].regVal[k],
+                                                                            mSimPipe->sim_pipe_vreg_file[tempIR.src2].regVal[k], 0, 0);
+                            }
+                        }
+                        mSimPipe->vector_chain_mask[i] = 0;
+                    }
                    /* unsigned temp;
                     opcode_t tempOpCode;
                     temp = mSimPipe->sim_pipe_pipeline_reg[MEM].Rd;
                     tempOpCode = mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode;
-                    if (temp < REGISTER_FILE_SIZE) {
+                    if (temp < MAX_PHYSICAL_REGISTERS) {
                         if ((is_int_alu(tempOpCode)) || (tempOpCode == LW)) {
                             mSimPipe->sim_pipe_reg_file[temp].isDestination = TRUE;
                         } else if ((is_fp_alu(tempOpCode)) || (tempOpCode == LWS)) {
@@ -969,18 +2886,29 @@ void pipe_EXE_Handler(sim_pipe_fp* mSimPipe)
                     }*/
                     mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = TRUE;
                     mSimPipe->sim_pipe_pipeline_reg_EXE[i].isAvailable = FALSE;
+                    mSimPipe->unit_wait_cause[i] = STALL_STRUCTURAL;
                     mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode = NOP;
                     mSimPipe->exec_units[i].instruction.opcode = NOP;
                 } else {
                     //Exe has processed instr but mem is busy so retry next cycle
                     mSimPipe->exec_units[i].busy++;
-                    //mStalls_Count++;
+                    if (mSimPipe->is_memory_ongoing == TRUE) {
+                        mSimPipe->unit_wait_cause[i] = STALL_MEMORY_LATENCY;
+                    } else if (mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == TRUE) {
+                        mSimPipe->unit_wait_cause[i] = STALL_MEM_PORT;
+                    } else {
+                        mSimPipe->unit_wait_cause[i] = STALL_STRUCTURAL;
+                    }
+                    //mSimPipe->mStalls_Count++;
                 }
             }
         }
+        if (mSimPipe->stats_busy_units_histogram != UNDEFINED) {
+            mSimPipe->stats.sample(mSimPipe->stats_busy_units_histogram, tempBusyUnits);
+        }
     }else
     {
-        if ((is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == FALSE)) {
+        if ((mSimPipe->is_memory_ongoing == FALSE) && (mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == FALSE)) {
             mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode = EOP;
             mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = TRUE;
         }
@@ -996,33 +2924,36 @@ void pipe_EXE_Handler(sim_pipe_fp* mSimPipe)
 
 void pipe_MEM_Handler(sim_pipe_fp* mSimPipe)
 {
-    static unsigned mMemDelay = 0;
+    //trace replay: the data memory is not accessed
+    bool replay = (mSimPipe->trace_replay != NULL);
 
-    if(is_branch(mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode) && (is_branch_ongoing == TRUE))
+    if(is_branch(mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode) && (mSimPipe->is_branch_ongoing == TRUE))
     {
-        is_branch_calculated = TRUE;
+        mSimPipe->is_branch_calculated = TRUE;
         if(mSimPipe->sim_pipe_pipeline_reg[MEM].Cond == 1)
         {
+            if(mSimPipe->workload_profile) mSimPipe->branches_taken[mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode]++;
             mSimPipe->sim_pipe_pipeline_reg[MEM].Cond = 0;
             mSimPipe->sim_pipe_pipeline_reg[IF].PC = mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output;
         }
     }
-    if((is_memory(mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode)) && (is_memory_ongoing == FALSE))
+    if((is_memory(mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode)) && (mSimPipe->is_memory_ongoing == FALSE))
     {
-        mMemDelay = mSimPipe->data_memory_latency + 1;
-        is_memory_ongoing = TRUE;
+        mSimPipe->mMemDelay = mSimPipe->data_memory_latency + 1;
+        mSimPipe->is_memory_ongoing = TRUE;
         mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = FALSE;
     }
-    if(is_memory_ongoing == TRUE)
+    if(mSimPipe->is_memory_ongoing == TRUE)
     {
-        if(mMemDelay <= 1)
+        if(mSimPipe->mMemDelay <= 1)
         {
-            is_memory_ongoing = FALSE;
+            mSimPipe->is_memory_ongoing = FALSE;
             mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable = TRUE;
         }else
         {
-           // mStalls_Count++;
-            mMemDelay--;
+           // mSimPipe->mStalls_Count++;
+            mSimPipe->memory_busy_cycles++;
+            mSimPipe->mMemDelay--;
         }
     }
     if(mSimPipe->sim_pipe_pipeline_reg[MEM].isAvailable == TRUE)
@@ -1034,12 +2965,28 @@ void pipe_MEM_Handler(sim_pipe_fp* mSimPipe)
     {
         //mSimPipe->sim_pipe_pipeline_reg[WB].IR = mSimPipe->sim_pipe_pipeline_reg[MEM].IR;
         mSimPipe->sim_pipe_pipeline_reg[WB].Rd = mSimPipe->sim_pipe_pipeline_reg[MEM].Rd;
+        mSimPipe->sim_pipe_pipeline_reg[WB].IR.exit_cycle[MEM] = mSimPipe->mClock_Cycles;
 
         unsigned temp;
         opcode_t tempOpCode;
         temp = mSimPipe->sim_pipe_pipeline_reg[MEM].Rd;
         tempOpCode = mSimPipe->sim_pipe_pipeline_reg[MEM].IR.opcode;
-        if(temp < REGISTER_FILE_SIZE)
+        if(is_memory(tempOpCode))
+        {
+            if((tempOpCode == SW) || (tempOpCode == SWS) || is_vector_store(tempOpCode)) mSimPipe->memory_stores++;
+            else mSimPipe->memory_loads++;
+            if(mSimPipe->workload_profile && !replay)
+            {
+                profile_memory_access(mSimPipe, tempOpCode, mSimPipe->sim_pipe_pipeline_reg[MEM].IR.address, mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output);
+            }
+            if((mSimPipe->reuse_analysis != NULL) && !replay)
+            {
+                unsigned elements = is_vector_memory(tempOpCode) ? mSimPipe->vector_length : 1;
+                for (unsigned k = 0; k < elements; k++)
+                    mSimPipe->reuse_analysis->access(mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output + k * mSimPipe->sim_pipe_pipeline_reg[MEM].B);
+            }
+        }
+        if(temp < MAX_PHYSICAL_REGISTERS)
         {
             if((is_int_alu(tempOpCode)) || (tempOpCode == LW))
             {
@@ -1060,7 +3007,7 @@ void pipe_MEM_Handler(sim_pipe_fp* mSimPipe)
         {
             mSimPipe->sim_pipe_pipeline_reg[WB].ALU_Output = UNDEFINED;
         }
-        if ((tempOpCode == LW) || (tempOpCode == LWS))
+        if (((tempOpCode == LW) || (tempOpCode == LWS)) && !replay)
         {
             temp = mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output;
             if(temp < mSimPipe->data_memory_size)
@@ -1075,7 +3022,28 @@ void pipe_MEM_Handler(sim_pipe_fp* mSimPipe)
         {
             mSimPipe->sim_pipe_pipeline_reg[WB].LMD = UNDEFINED;
         }
-        if ((tempOpCode == SW) || (tempOpCode == SWS))
+        if (is_vector(tempOpCode) && !replay)
+        {
+            //vector loads/stores access "vector_length" elements starting at ALU_Output, B bytes apart
+            for (unsigned k = 0; k < mSimPipe->vector_length; k++)
+            {
+                temp = mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output + k * mSimPipe->sim_pipe_pipeline_reg[MEM].B;
+                if (!is_vector_memory(tempOpCode))
+                {
+                    mSimPipe->vector_pipeline_reg[WB][k] = mSimPipe->vector_pipeline_reg[MEM][k];
+                } else if (temp + 3 >= mSimPipe->data_memory_size)
+                {
+                    cout << "LV/SV out of bound memory" << endl;
+                } else if (is_vector_store(tempOpCode))
+                {
+                    mSimPipe->write_memory(temp, mSimPipe->vector_pipeline_reg[MEM][k]);
+                } else
+                {
+                    mSimPipe->vector_pipeline_reg[WB][k] = char2unsigned(&mSimPipe->data_memory[temp]);
+                }
+            }
+        }
+        if (((tempOpCode == SW) || (tempOpCode == SWS)) && !replay)
         {
             //TODO: Check if write address is valid
             temp = mSimPipe->sim_pipe_pipeline_reg[MEM].ALU_Output;
@@ -1107,31 +3075,41 @@ void pipe_MEM_Handler(sim_pipe_fp* mSimPipe)
 void pipe_WB_Handler(sim_pipe_fp* mSimPipe)
 {
     unsigned tempRd;
+    //trace replay: the registers are not updated
+    bool replay = (mSimPipe->trace_replay != NULL);
     if(mSimPipe->sim_pipe_pipeline_reg[WB].isAvailable == TRUE)
     {
         tempRd = mSimPipe->sim_pipe_pipeline_reg[WB].Rd;
     }
     if((mSimPipe->sim_pipe_pipeline_reg[WB].isAvailable == TRUE) && (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode != NOP) && (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode != EOP))
     {
-        mInstruction_Count++;
-        if (tempRd < REGISTER_FILE_SIZE)
+        mSimPipe->mInstruction_Count++;
+        record_retire(mSimPipe, mSimPipe->sim_pipe_pipeline_reg[WB].IR);
+        if (tempRd < MAX_PHYSICAL_REGISTERS)
         {
             if (is_int_alu(mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode))
             {
-                mSimPipe->sim_pipe_reg_file[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].ALU_Output;
+                if (!replay) mSimPipe->sim_pipe_reg_file[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].ALU_Output;
                 mSimPipe->sim_pipe_reg_file[tempRd].isDestination = FALSE;
             }else if (is_fp_alu(mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode))
             {
-                mSimPipe->sim_pipe_reg_file_fp[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].ALU_Output;
+                if (!replay) mSimPipe->sim_pipe_reg_file_fp[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].ALU_Output;
                 mSimPipe->sim_pipe_reg_file_fp[tempRd].isDestination = FALSE;
             }else if (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode == LW)
             {
-                mSimPipe->sim_pipe_reg_file[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].LMD;
+                if (!replay) mSimPipe->sim_pipe_reg_file[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].LMD;
                 mSimPipe->sim_pipe_reg_file[tempRd].isDestination = FALSE;
             }else if (mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode == LWS)
             {
-                mSimPipe->sim_pipe_reg_file_fp[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].LMD;
+                if (!replay) mSimPipe->sim_pipe_reg_file_fp[tempRd].regVal = mSimPipe->sim_pipe_pipeline_reg[WB].LMD;
                 mSimPipe->sim_pipe_reg_file_fp[tempRd].isDestination = FALSE;
+            }else if (is_vector(mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode))
+            {
+                for (unsigned k = 0; !replay && (k < mSimPipe->vector_length); k++)
+                {
+                    mSimPipe->sim_pipe_vreg_file[tempRd].regVal[k] = mSimPipe->vector_pipeline_reg[WB][k];
+                }
+                mSimPipe->sim_pipe_vreg_file[tempRd].isDestination = FALSE;
             }else
             {
                 //Nothing to be done in WB
@@ -1142,6 +3120,11 @@ void pipe_WB_Handler(sim_pipe_fp* mSimPipe)
         mSimPipe->sim_pipe_pipeline_reg[WB].IR.opcode = NOP;
         mSimPipe->sim_pipe_pipeline_reg[WB].isAvailable = FALSE;
     }
+    if(mSimPipe->register_renaming)
+    {
+        rename_release_registers(mSimPipe, &mSimPipe->rename_int, mSimPipe->sim_pipe_reg_file);
+        rename_release_registers(mSimPipe, &mSimPipe->rename_fp, mSimPipe->sim_pipe_reg_file_fp);
+    }
 
 }
 
@@ -1200,4 +3183,296 @@ unsigned isOpCodeFpType(opcode_t mOpCode)
         mRetVal=TRUE;
     }
     return mRetVal;
-}
\ No newline at end of file
+}
+/* returns the vector registers read by a vector instruction as a bit mask */
+unsigned vector_sources_mask(instruction_t mInstr)
+{
+    unsigned mRetVal = 0;
+    if(is_vector_store(mInstr.opcode) || is_vector_alu(mInstr.opcode))
+    {
+        mRetVal |= (1u << mInstr.src1);
+    }
+    if(is_vector_alu(mInstr.opcode))
+    {
+        mRetVal |= (1u << mInstr.src2);
+    }
+    return mRetVal;
+}
+
+/* a vector source can be chained once its producer has delivered the first element */
+unsigned vector_chain_ready(sim_pipe_fp* mSimPipe, unsigned mReg)
+{
+    for(unsigned i=0;i<mSimPipe->num_units;i++)
+    {
+        if((mSimPipe->sim_pipe_pipeline_reg_EXE[i].isAvailable == TRUE) &&
+           is_vector(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR.opcode) &&
+           (mSimPipe->sim_pipe_pipeline_reg_EXE[i].Rd == mReg))
+        {
+            return (mSimPipe->exec_units[i].busy <= mSimPipe->vector_length) ? TRUE : FALSE;
+        }
+    }
+    //producer already left the vector unit
+    return TRUE;
+}
+
+/* hazard detection for the vector instruction in ID */
+void vector_hazard_check(sim_pipe_fp* mSimPipe, unsigned *isRAWPresent, unsigned *isWAWPresent, unsigned *chainMask)
+{
+    instruction_t tempIR = mSimPipe->sim_pipe_pipeline_reg[ID].IR;
+    unsigned tempBase = is_vector_store(tempIR.opcode) ? tempIR.src2 : tempIR.src1;
+    unsigned tempSources = vector_sources_mask(tempIR);
+
+    //integer base and stride registers
+    if(is_vector_memory(tempIR.opcode))
+    {
+        if(mSimPipe->sim_pipe_reg_file[tempBase].isDestination == TRUE) *isRAWPresent = TRUE;
+        if((tempIR.src3 < MAX_PHYSICAL_REGISTERS) && (mSimPipe->sim_pipe_reg_file[tempIR.src3].isDestination == TRUE)) *isRAWPresent = TRUE;
+    }
+    //vector sources still being produced: chain if possible, stall otherwise
+    for(unsigned v=0;v<NUM_VECTOR_REGISTERS;v++)
+    {
+        if((tempSources & (1u << v)) && (mSimPipe->sim_pipe_vreg_file[v].isDestination == TRUE))
+        {
+            if(mSimPipe->vector_chaining && (vector_chain_ready(mSimPipe, v) == TRUE))
+            {
+                *chainMask |= (1u << v);
+            }else
+            {
+                *isRAWPresent = TRUE;
+            }
+        }
+    }
+    //vector destination: pending write (WAW) or still to be read by a vector unit (WAR)
+    if(tempIR.dest < NUM_VECTOR_REGISTERS)
+    {
+        if(mSimPipe->sim_pipe_vreg_file[tempIR.dest].isDestination == TRUE) *isWAWPresent = TRUE;
+        for(unsigned i=0;i<mSimPipe->num_units;i++)
+        {
+            if((mSimPipe->sim_pipe_pipeline_reg_EXE[i].isAvailable == TRUE) &&
+               (vector_sources_mask(mSimPipe->sim_pipe_pipeline_reg_EXE[i].IR) & (1u << tempIR.dest)))
+            {
+                *isWAWPresent = TRUE;
+            }
+        }
+    }
+}
+
+/* TRUE while a chained vector source of the instruction in "unit" has not been written back */
+unsigned vector_chain_pending(sim_pipe_fp* mSimPipe, unsigned unit)
+{
+    for(unsigned v=0;v<NUM_VECTOR_REGISTERS;v++)
+    {
+        if((mSimPipe->vector_chain_mask[unit] & (1u << v)) && (mSimPipe->sim_pipe_vreg_file[v].isDestination == TRUE))
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* renames the integer and FP source registers of an instruction through the current map */
+void rename_sources(sim_pipe_fp* mSimPipe, instruction_t *mInstr)
+{
+    unsigned *intMap = mSimPipe->rename_int.map;
+    unsigned *fpMap = mSimPipe->rename_fp.map;
+    switch(mInstr->opcode)
+    {
+        case ADD: case SUB: case XOR:
+            mInstr->src1 = intMap[mInstr->src1];
+            mInstr->src2 = intMap[mInstr->src2];
+            break;
+        case ADDI: case SUBI: case LW: case LWS: case LOOP:
+        case BEQZ: case BNEZ: case BLTZ: case BGTZ: case BLEZ: case BGEZ:
+            mInstr->src1 = intMap[mInstr->src1];
+            break;
+        case SW:
+            mInstr->src1 = intMap[mInstr->src1];
+            mInstr->src2 = intMap[mInstr->src2];
+            break;
+        case SWS:
+            mInstr->src1 = fpMap[mInstr->src1];
+            mInstr->src2 = intMap[mInstr->src2];
+            break;
+        case FMADDS:
+            mInstr->src3 = fpMap[mInstr->src3];
+            /* fall through */
+        case ADDS: case SUBS: case MULTS: case DIVS:
+            mInstr->src1 = fpMap[mInstr->src1];
+            mInstr->src2 = fpMap[mInstr->src2];
+            break;
+        case LV: case LVWS:
+            mInstr->src1 = intMap[mInstr->src1];
+            if (mInstr->src3 < REGISTER_FILE_SIZE) mInstr->src3 = intMap[mInstr->src3];
+            break;
+        case SV: case SVWS:
+            mInstr->src2 = intMap[mInstr->src2];
+            if (mInstr->src3 < REGISTER_FILE_SIZE) mInstr->src3 = intMap[mInstr->src3];
+            break;
+        default:
+            break;
+    }
+}
+
+/* returns the rename table of the destination of the instruction, NULL if it has no R/F destination */
+renameTable_t *rename_dest_table(sim_pipe_fp* mSimPipe, opcode_t mOpCode)
+{
+    if (is_int_alu(mOpCode) || (mOpCode == LW)) return &mSimPipe->rename_int;
+    if (is_fp_alu(mOpCode) || (mOpCode == LWS)) return &mSimPipe->rename_fp;
+    return NULL;
+}
+
+/* moves the released physical registers whose producer has written back to the free list */
+void rename_release_registers(sim_pipe_fp* mSimPipe, renameTable_t *mTable, regFileElement_t *mRegFile)
+{
+    unsigned k = 0;
+    for (unsigned i = 0; i < mTable->num_pending; i++)
+    {
+        if (mRegFile[mTable->pending_free[i]].isDestination == TRUE)
+        {
+            mTable->pending_free[k++] = mTable->pending_free[i];
+        } else
+        {
+            mTable->free_list[mTable->num_free++] = mTable->pending_free[i];
+        }
+    }
+    mTable->num_pending = k;
+}
+
+/* source operand (1: src1, 2: src2, 3: src3) of the instruction in ID still waiting for its producer, 0 if none */
+unsigned stall_raw_operand(sim_pipe_fp* mSimPipe)
+{
+    const instruction_t &tempIR = mSimPipe->sim_pipe_pipeline_reg[ID].IR;
+    for(unsigned f=1;f<=3;f++)
+    {
+        unsigned tempReg = (f == 1) ? tempIR.src1 : ((f == 2) ? tempIR.src2 : tempIR.src3);
+        unsigned isPending = FALSE;
+        char tempClass = operand_class(tempIR.opcode, f);
+        if(tempReg >= MAX_PHYSICAL_REGISTERS) continue;
+        if(tempClass == 'R') isPending = mSimPipe->sim_pipe_reg_file[tempReg].isDestination;
+        if(tempClass == 'F') isPending = mSimPipe->sim_pipe_reg_file_fp[tempReg].isDestination;
+        if((tempClass == 'V') && (tempReg < NUM_VECTOR_REGISTERS)) isPending = mSimPipe->sim_pipe_vreg_file[tempReg].isDestination;
+        if(isPending == TRUE) return f;
+    }
+    return 0;
+}
+
+/* counts a stall cycle and attributes it to the instruction stalled in ID */
+void record_stall(sim_pipe_fp* mSimPipe, stall_cause_t mCause)
+{
+    mSimPipe->mStalls_Count++;
+    mSimPipe->stall_counts[mCause]++;
+    unsigned tempIndex = (mSimPipe->sim_pipe_pipeline_reg[ID].NPC - 4 - mSimPipe->instr_base_address) / 4;
+    if(tempIndex >= PROGRAM_SIZE) return;
+    stallProfileEntry_t &tempEntry = mSimPipe->stall_profile[tempIndex];
+    tempEntry.cycles[mCause]++;
+    if(mCause == STALL_RAW)
+    {
+        unsigned tempOperand = stall_raw_operand(mSimPipe);
+        if(tempOperand != 0) tempEntry.raw_operands[tempOperand-1]++;
+    }
+}
+
+/* no unit free for the instruction in ID: busy computing, or done and waiting for the MEM stage */
+stall_cause_t structural_stall_cause(sim_pipe_fp* mSimPipe, opcode_t mOpCode)
+{
+    stall_cause_t mRetVal = STALL_STRUCTURAL;
+    for(unsigned i=0;i<mSimPipe->num_units;i++)
+    {
+        if(mSimPipe->exec_units[i].type != unit_type(mOpCode)) continue;
+        if(mSimPipe->unit_wait_cause[i] == STALL_STRUCTURAL) return STALL_STRUCTURAL;
+        if(mSimPipe->unit_wait_cause[i] == STALL_MEMORY_LATENCY) mRetVal = STALL_MEMORY_LATENCY;
+        else if(mRetVal == STALL_STRUCTURAL) mRetVal = STALL_MEM_PORT;
+    }
+    return mRetVal;
+}
+
+/* register file (0: R, 1: F, 2: V) of a register class returned by operand_class */
+static unsigned profile_register_file(char mClass)
+{
+    return (mClass == 'R') ? 0 : ((mClass == 'F') ? 1 : 2);
+}
+
+/* workload profile of a retiring instruction: opcode count and distance from the producers of its
+   sources, i.e. the latest writer of each source register fetched before it (producers retire before
+   their consumers read the registers, but younger writers may retire first) */
+static void profile_retire(sim_pipe_fp* mSimPipe, instruction_t &mInstr)
+{
+    mSimPipe->mix_counts[mInstr.opcode]++;
+    unsigned tempIndex = (mInstr.address - mSimPipe->instr_base_address) / 4;
+    if(tempIndex >= PROGRAM_SIZE) return;
+    instruction_t &tempArch = mSimPipe->instr_memory[tempIndex];  //architectural registers
+    unsigned tempSources[3] = {tempArch.src1, tempArch.src2, tempArch.src3};
+    for(unsigned f=1;f<=3;f++)
+    {
+        char tempClass = operand_class(tempArch.opcode, f);
+        unsigned tempReg = tempSources[f-1];
+        if(tempClass == 0 || tempReg >= REGISTER_FILE_SIZE) continue;
+        unsigned *tempWriters = mSimPipe->last_writers[profile_register_file(tempClass)][tempReg];
+        unsigned tempProducer = UNDEFINED;
+        for(unsigned w=0;w<WRITER_HISTORY;w++)
+        {
+            if(tempWriters[w] < mInstr.seq && (tempProducer == UNDEFINED || tempWriters[w] > tempProducer)) tempProducer = tempWriters[w];
+        }
+        if(tempProducer != UNDEFINED) mSimPipe->stats.sample(mSimPipe->stats_raw_distance_histogram, mInstr.seq - tempProducer);
+    }
+    char tempDest = 0;
+    if(is_int_alu(tempArch.opcode) || tempArch.opcode == LW) tempDest = 'R';
+    else if(is_fp_alu(tempArch.opcode) || tempArch.opcode == LWS) tempDest = 'F';
+    else if(tempArch.opcode == LV || tempArch.opcode == LVWS || is_vector_alu(tempArch.opcode)) tempDest = 'V';
+    if(tempDest != 0 && tempArch.dest < REGISTER_FILE_SIZE)
+    {
+        //the oldest writer is forgotten
+        unsigned *tempWriters = mSimPipe->last_writers[profile_register_file(tempDest)][tempArch.dest];
+        unsigned tempOldest = 0;
+        for(unsigned w=1;w<WRITER_HISTORY;w++)
+        {
+            if(tempWriters[w] == UNDEFINED || (tempWriters[tempOldest] != UNDEFINED && tempWriters[w] < tempWriters[tempOldest])) tempOldest = w;
+        }
+        tempWriters[tempOldest] = mInstr.seq;
+    }
+}
+
+/* workload profile of a memory access: stride from the previous execution of the same instruction */
+void profile_memory_access(sim_pipe_fp* mSimPipe, opcode_t mOpCode, unsigned mPC, unsigned mAddress)
+{
+    unsigned tempIndex = (mPC - mSimPipe->instr_base_address) / 4;
+    if(tempIndex >= PROGRAM_SIZE) return;
+    unsigned &tempLast = mSimPipe->last_address[tempIndex];
+    if(tempLast != UNDEFINED)
+    {
+        unsigned tempStride = (mAddress > tempLast) ? mAddress - tempLast : tempLast - mAddress;
+        bool tempStore = (mOpCode == SW) || (mOpCode == SWS) || is_vector_store(mOpCode);
+        mSimPipe->stats.sample(tempStore ? mSimPipe->stats_store_stride_histogram : mSimPipe->stats_load_stride_histogram, tempStride);
+    }
+    tempLast = mAddress;
+}
+
+/* accumulates the stage cycles of a retiring instruction into the profile of its PC */
+void record_retire(sim_pipe_fp* mSimPipe, instruction_t &mInstr)
+{
+    mInstr.exit_cycle[WB] = mSimPipe->mClock_Cycles;
+    unsigned tempIndex = (mInstr.address - mSimPipe->instr_base_address) / 4;
+    if(tempIndex < PROGRAM_SIZE)
+    {
+        instrProfileEntry_t &tempEntry = mSimPipe->instr_profile[tempIndex];
+        tempEntry.retired++;
+        tempEntry.stage_cycles[IF] += 1;
+        for(unsigned s=ID;s<NUM_STAGES;s++)
+        {
+            tempEntry.stage_cycles[s] += mInstr.exit_cycle[s] - mInstr.exit_cycle[s-1];
+        }
+        tempEntry.latency += mInstr.exit_cycle[WB] - mInstr.exit_cycle[IF] + 1;
+    }
+    if(mSimPipe->stats_latency_histogram != UNDEFINED)
+    {
+        mSimPipe->stats.sample(mSimPipe->stats_latency_histogram, mInstr.exit_cycle[WB] - mInstr.exit_cycle[IF] + 1);
+    }
+    if(mSimPipe->pipeline_trace != NULL)
+    {
+        mSimPipe->pipeline_trace->retire(mInstr, mSimPipe->exec_units[mInstr.unit].type);
+    }
+    if(mSimPipe->workload_profile)
+    {
+        profile_retire(mSimPipe, mInstr);
+    }
+}
@@ -3,32 +3,49 @@
 
 #include <stdio.h>
 #include <string>
+#include <map>
+#include "sim_stats.h"
 
 using namespace std;
 
-#define PROGRAM_SIZE 50
+#define PROGRAM_SIZE 1024
 
 #define UNDEFINED 0xFFFFFFFF
 #define NUM_SP_REGISTERS 9
 #define NUM_SP_INT_REGISTERS 15
 #define NUM_GP_REGISTERS 32
-#define NUM_OPCODES 22
+#define NUM_OPCODES 32
 #define NUM_STAGES 5
 #define MAX_UNITS 10
+#define LOOP_BUFFER_SIZE 16
+#define NUM_UNIT_TYPES 8
+#define NUM_VECTOR_REGISTERS 8
+#define MAX_VECTOR_LENGTH 64
+#define NUM_STALL_CAUSES 7
+#define WRITER_HISTORY 4   //latest writers of each register remembered by the workload profile
+#define WRITE_TRACKING_LINE 64   //bytes of data memory per flag of the write tracking
 
 /** Added Code Start**/
 #define  TRUE 1
 #define FALSE 0
 #define REGISTER_FILE_SIZE 32
+#define MAX_PHYSICAL_REGISTERS 128
 /** Added Code End**/
 
 typedef enum {PC, NPC, IR, A, B, IMM, COND, ALU_OUTPUT, LMD} sp_register_t;
 
-typedef enum {LW, SW, ADD, ADDI, SUB, SUBI, XOR, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP, LWS, SWS, ADDS, SUBS, MULTS, DIVS} opcode_t;
+typedef enum {LW, SW, ADD, ADDI, SUB, SUBI, XOR, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP, LWS, SWS, ADDS, SUBS, MULTS, DIVS, LOOP, ENDLOOP, LV, SV, LVWS, SVWS, ADDV, SUBV, MULV, FMADDS} opcode_t;
 
 typedef enum {IF, ID, EXE, MEM, WB} stage_t;
 
-typedef enum {INTEGER, ADDER, MULTIPLIER, DIVIDER} exe_unit_t;
+typedef enum {INTEGER, ADDER, MULTIPLIER, DIVIDER, VECTOR_ADDER, VECTOR_MULTIPLIER, VECTOR_MEMORY, FMA} exe_unit_t;
+
+// cause of a stall cycle inserted in ID
+// - STALL_STRUCTURAL: no free execution unit of the required type
+// - STALL_MEM_PORT / STALL_MEMORY_LATENCY: the units of the required type are done but cannot
+//   move to MEM because the MEM stage is occupied / waiting for the data memory
+// - STALL_RENAME: no free physical register (register renaming enabled)
+typedef enum {STALL_RAW, STALL_WAW, STALL_STRUCTURAL, STALL_MEM_PORT, STALL_CONTROL, STALL_MEMORY_LATENCY, STALL_RENAME} stall_cause_t;
 
 // instruction
 typedef struct{
@@ -36,8 +53,14 @@ typedef struct{
         unsigned src1; //first source register
         unsigned src2; //second source register
         unsigned dest; //destination register
+        unsigned src3; //third source register (addend of FMADDS, stride register of LVWS/SVWS)
         unsigned immediate; //immediate field;
         string label; //in case of branch, label of the target instruction;
+        // dynamic information, filled in as the instruction flows through the pipeline
+        unsigned address; //address the instruction was fetched from
+        unsigned seq; //fetch sequence number
+        unsigned unit; //execution unit the instruction was issued to
+        unsigned exit_cycle[NUM_STAGES]; //clock cycle in which the instruction left each stage
 } instruction_t;
 
 /** Added Code Start**/
@@ -47,6 +70,35 @@ typedef  struct
     bool isDestination;
 }regFileElement_t;
 
+typedef  struct
+{
+    unsigned regVal[MAX_VECTOR_LENGTH];
+    bool isDestination;
+}vectorRegFileElement_t;
+
+typedef  struct
+{
+    unsigned map[REGISTER_FILE_SIZE];               //architectural -> physical register
+    unsigned free_list[MAX_PHYSICAL_REGISTERS];     //physical registers available for allocation
+    unsigned num_free;
+    unsigned pending_free[MAX_PHYSICAL_REGISTERS];  //released registers whose producer has not written back yet
+    unsigned num_pending;
+    unsigned max_in_use;                            //peak number of allocated physical registers
+}renameTable_t;
+
+typedef  struct
+{
+    unsigned cycles[NUM_STALL_CAUSES];       //stall cycles of the instruction, per cause
+    unsigned raw_operands[3];                //RAW stall cycles waiting for src1, src2 and src3
+}stallProfileEntry_t;
+
+typedef  struct
+{
+    unsigned retired;                        //number of times the instruction retired
+    unsigned long long stage_cycles[NUM_STAGES]; //cycles spent in each stage, summed over all executions
+    unsigned long long latency;              //fetch-to-retire latency, summed over all executions
+}instrProfileEntry_t;
+
 
 typedef  struct
 {
@@ -57,6 +109,7 @@ typedef  struct
     unsigned Imm;
     unsigned A;
     unsigned B;
+    unsigned C;
     unsigned ALU_Output;
     unsigned Cond;
     unsigned LMD;
@@ -76,13 +129,48 @@ typedef struct{
 	instruction_t instruction; // instruction using the functional unit
 } unit_t;
 
+// buffered writer of the pipeline trace (defined in sim_pipe_fp.cc)
+class pipe_trace_writer;
+
+// record of the dynamic instruction stream (see record_trace and replay_trace)
+typedef struct{
+	unsigned pc;            //address of the instruction
+	unsigned value;         //effective address (memory operations), next PC (branches), iterations (LOOP)
+	unsigned char opcode;
+	unsigned char dest;     //registers, as in the instruction memory (0xFF if not used)
+	unsigned char src1;
+	unsigned char src2;
+	unsigned char taken;    //branch taken, ENDLOOP redirected to the loop body
+	unsigned char pad[3];
+} trace_record_t;
+
+// writer and reader of the compressed instruction traces (see sim_trace.h)
+class instr_trace_writer;
+class instr_trace_reader;
+
+// stack-distance analyzer of the data accesses (see sim_reuse.h)
+class reuse_analyzer;
+
+// dependence graph of the dynamic instruction stream (see sim_dataflow.h)
+class dataflow_analyzer;
+
 class sim_pipe_fp{
 public:
     /** Added Code Start**/
-    regFileElement_t sim_pipe_reg_file_fp[REGISTER_FILE_SIZE];
-    regFileElement_t sim_pipe_reg_file[REGISTER_FILE_SIZE];
+    regFileElement_t sim_pipe_reg_file_fp[MAX_PHYSICAL_REGISTERS];
+    regFileElement_t sim_pipe_reg_file[MAX_PHYSICAL_REGISTERS];
     pipelineRegVals_t sim_pipe_pipeline_reg[NUM_STAGES];
     pipelineRegVals_t sim_pipe_pipeline_reg_EXE[MAX_UNITS];
+
+    //counters and pipeline control state, per instance so that several simulators can run concurrently
+    unsigned mInstruction_Count;
+    unsigned mClock_Cycles;
+    unsigned mStalls_Count;
+    unsigned is_memory_ongoing;
+    unsigned is_branch_ongoing;
+    unsigned is_branch_calculated;
+    unsigned mControlDelay;   //cycles the branch in ID has been waiting
+    unsigned mMemDelay;       //cycles left for the memory access in MEM
     /** Added Code End**/
         //instruction memory 
         instruction_t instr_memory[PROGRAM_SIZE];
@@ -99,10 +187,109 @@ public:
 	//memory latency in clock cycles
 	unsigned data_memory_latency;
 
+	//digest of the data memory, maintained by write_memory (0 for a memory with all bytes at 0xFF)
+	unsigned long long memory_digest;
+
+	//false after a data image has been mapped: the digest is then recomputed by the next memory_hash()
+	bool memory_digest_valid;
+
+	//size of the anonymous mapping backing the data memory (the memory size rounded up to a page)
+	size_t data_memory_mapping_size;
+
+	//true if data images are mapped in the data memory (reset() replaces them with an empty memory)
+	bool data_image_mapped;
+
+	//data memory lines written since the write tracking was enabled or since the last
+	//copy_architectural_state (see enable_write_tracking); empty when the tracking is disabled
+	vector<unsigned char> written_lines;  //one flag per WRITE_TRACKING_LINE bytes
+	vector<unsigned> written_list;        //lines flagged, in the order they were first written
+
 	//execution units
 	unit_t exec_units[MAX_UNITS];
 	unsigned num_units;
 
+	//vector extension: vector register file, vector length (VL) and chaining between vector units
+	//vector units occupy "latency + VL - 1" cycles; with chaining enabled a vector instruction
+	//may issue as soon as the first element of a vector source has been produced
+	vectorRegFileElement_t sim_pipe_vreg_file[NUM_VECTOR_REGISTERS];
+	unsigned vector_length;
+	bool vector_chaining;
+	unsigned vector_chain_mask[MAX_UNITS];   //vector sources still being produced when the unit was issued
+	unsigned vector_pipeline_reg[NUM_STAGES][MAX_VECTOR_LENGTH]; //vector values in EX/MEM and MEM/WB
+
+	//hardware loop support (LOOP Rs ... ENDLOOP)
+	//LOOP loads the loop counter with Rs when it issues; ENDLOOP is folded at fetch and
+	//redirects to the first body instruction while the counter is above 1 (the body always
+	//executes at least once). Nested hardware loops are not supported.
+	unsigned loop_counter;
+	unsigned loop_start;     //address of the first instruction of the loop body
+	instruction_t loop_buffer[LOOP_BUFFER_SIZE]; //fetch-side buffer holding the loop body
+	unsigned loop_buffer_valid;  //number of valid entries in the loop buffer
+	unsigned loop_buffer_hits;   //instructions fetched from the loop buffer
+
+	//register renaming (disabled by default): the R and F registers are mapped onto pools of
+	//"num_physical_registers" physical registers. Sources are renamed when the instruction is
+	//fetched into IF/ID, destinations get a new physical register at issue, and the previous
+	//mapping is released once its producer has written back. This removes WAW stalls at issue.
+	bool register_renaming;
+	unsigned num_physical_registers;
+	renameTable_t rename_int;
+	renameTable_t rename_fp;
+	unsigned rename_arch_dest[MAX_UNITS];  //architectural destination of the instruction in each unit
+	unsigned rename_waw_eliminated;        //WAW stall cycles avoided thanks to renaming
+	unsigned rename_pool_stalls;           //stalls due to an empty free list
+
+	//labels of the loaded program (label -> instruction number)
+	map<string, unsigned> labels;
+
+	//stall profile: every stall cycle is attributed to the instruction stalled in ID (indexed by
+	//instruction number, as instr_memory)
+	stallProfileEntry_t stall_profile[PROGRAM_SIZE];
+	stall_cause_t unit_wait_cause[MAX_UNITS];  //why a unit that completed execution is still held
+
+	//hot-spot profile: retired instructions and per-stage cycles, per static instruction (indexed
+	//by instruction number, as instr_memory)
+	instrProfileEntry_t instr_profile[PROGRAM_SIZE];
+	unsigned fetch_seq;  //sequence number of the next fetched instruction
+
+	//pipeline trace (NULL when disabled)
+	pipe_trace_writer *pipeline_trace;
+
+	//instruction trace written by fast_forward while recording, and trace driving the pipeline
+	//while replaying (NULL when disabled)
+	instr_trace_writer *trace_recorder;
+	instr_trace_reader *trace_replay;
+	unsigned replay_loop_count;  //iterations of the LOOP fetched from the trace, loaded when it issues
+
+	//stack-distance analysis of the data addresses accessed in MEM (NULL when disabled)
+	reuse_analyzer *reuse_analysis;
+
+	//dataflow limit study fed by fast_forward (NULL when no analysis was made)
+	dataflow_analyzer *dataflow_analysis;
+
+	//statistics registry: the counters below (and the global counters) are registered by register_stats
+	sim_stats stats;
+	unsigned stats_interval;                    //dump period in clock cycles, 0 to dump once per run
+	unsigned stall_counts[NUM_STALL_CAUSES];    //stall cycles per cause
+	unsigned unit_issued[MAX_UNITS];            //instructions issued to each execution unit
+	unsigned unit_busy_cycles[MAX_UNITS];       //cycles each execution unit is busy
+	unsigned memory_loads;
+	unsigned memory_stores;
+	unsigned memory_busy_cycles;                //cycles spent waiting for the data memory
+	unsigned stats_latency_histogram;           //fetch-to-retire latency (UNDEFINED if not registered)
+	unsigned stats_busy_units_histogram;        //number of busy execution units per cycle (UNDEFINED if not registered)
+
+	//workload characterization (see enable_workload_profile)
+	bool workload_profile;
+	unsigned mix_counts[NUM_OPCODES];           //instructions retired per opcode
+	unsigned branches_taken[NUM_OPCODES];       //taken branches per opcode
+	unsigned stats_raw_distance_histogram;      //RAW dependency distance (UNDEFINED if not registered)
+	unsigned stats_load_stride_histogram;       //address stride between successive executions of a load
+	unsigned stats_store_stride_histogram;      //address stride between successive executions of a store
+	unsigned last_writers[3][REGISTER_FILE_SIZE][WRITER_HISTORY]; //fetch sequence numbers of the latest retired
+	                                            //writers of each R, F and V register (UNDEFINED if none)
+	unsigned last_address[PROGRAM_SIZE];        //latest effective address of each static memory instruction
+
 
 
 	//instantiates the simulator with a data memory of given size (in bytes) and latency (in clock cycles)
@@ -124,8 +311,78 @@ public:
 	//loads the assembly program in file "filename" in instruction memory at the specified address
 	void load_program(const char *filename, unsigned base_address=0x0);
 
+	//optional optimization pass, to be invoked after load_program (and after the execution units
+	//have been configured): reorders the instructions of each basic block with a latency-aware list
+	//scheduler, preserving all register (RAW/WAR/WAW) and memory dependences
+	void schedule_program();
+
+	//enables register renaming with "num_physical" physical registers per register file
+	//(REGISTER_FILE_SIZE < num_physical <= MAX_PHYSICAL_REGISTERS); to be invoked before run
+	void enable_register_renaming(unsigned num_physical);
+
+	//prints the statistics of the rename stage (stalls eliminated, register pool pressure)
+	void print_renaming_stats();
+
+	//optional transformation, to be invoked after load_program: unrolls simple counted loops
+	//(a label, a straight-line body updating an induction variable by a constant and a backward
+	//BNEZ) by "factor", renaming loop-local registers to registers unused by the program.
+	//A remainder loop (the original one) handles the last 1..factor iterations.
+	void unroll_loops(unsigned factor);
+
 	//runs the simulator for "cycles" clock cycles (run the program to completion if cycles=0) 
 	void run(unsigned cycles=0);
+
+	//functional simulation: executes up to "instructions" instructions on the architectural state
+	//(registers, data memory, PC and hardware loop) without modeling the pipeline, stopping at EOP;
+	//returns the number of instructions executed. The pipeline must be empty (e.g. right after
+	//load_program) and the pipeline counters are not updated
+	unsigned fast_forward(unsigned instructions);
+
+	//copies the architectural state of "source" (registers, data memory, PC and hardware loop) into
+	//this simulator, whose pipeline must be empty; program and configuration are left unchanged.
+	//Used to start a detailed simulation from the state reached by fast_forward
+	void copy_architectural_state(sim_pipe_fp *source);
+
+	//tracks the data memory lines written: copy_architectural_state between two simulators that both
+	//track their writes copies only the lines either of them wrote since their memories were last made
+	//equal (by a copy_architectural_state with the tracking disabled on either side). Ends at reset()
+	void enable_write_tracking();
+
+	//empties the pipeline and clears the counters and the profiles, keeping the program, the
+	//configuration and the optional analyses, then continues from the architectural state of "source"
+	//(see copy_architectural_state). Used to reuse one detailed simulator for many samples
+	void restart_from(sim_pipe_fp *source);
+
+	//records the dynamic instruction stream of the program into "filename": PC, opcode, registers,
+	//effective address and branch outcome of every instruction. The program is executed functionally
+	//(see fast_forward) from the current state to EOP; returns the number of instructions recorded
+	unsigned record_trace(const char *filename);
+
+	//replays a trace written by record_trace: the following runs take the instruction stream from the
+	//trace instead of following the PC and simulate the timing only (no ALU operation, data memory
+	//access or register update). The program must be loaded; execution units, latencies and register
+	//renaming may differ from the ones of the recording. The replay ends at reset()
+	//Note: the replay is not faster than a detailed run. It still simulates every cycle through all the
+	//stages and units, and on stall-bound programs most cycles compute no value anyway
+	void replay_trace(const char *filename);
+
+	//dataflow limit study: executes the program functionally (see fast_forward) from the current state
+	//to EOP, building the dependence graph of the dynamic instructions through registers and memory with
+	//the latencies of the configured units (as seen by the list scheduler: execution cycles of the unit,
+	//plus the vector length - 1 for vector instructions and the data memory latency for loads).
+	//Its critical path bounds the clock cycles of any pipeline with these latencies (unlimited units,
+	//perfect control flow); returns the number of instructions analyzed. The results last until reset()
+	unsigned analyze_dataflow();
+
+	//returns the length (clock cycles) of the critical path found by analyze_dataflow
+	unsigned long long get_critical_path();
+
+	//returns the IPC allowed by the dependences (instructions / critical path)
+	float get_ideal_IPC();
+
+	//prints the critical path and ideal IPC found by analyze_dataflow, and the "max_instructions"
+	//static instructions with the most dynamic instances on the critical path
+	void print_dataflow_analysis(unsigned max_instructions=10);
 	
 	//resets the state of the simulator
         /* Note: 
@@ -134,6 +391,9 @@ public:
 	*/
 	void reset();
 
+	//empties the pipeline and clears the counters and the profiles (see reset and restart_from)
+	void reset_pipeline();
+
 	// returns value of the specified special purpose register for a given stage (at the "entrance" of that stage)
         // if that special purpose register is not used in that stage, returns UNDEFINED
         //
@@ -161,6 +421,18 @@ public:
         //set the value of the given floating point general purpose register to "value"
         void set_fp_register(unsigned reg, float value);
 
+        //returns the given element of the specified vector register
+        float get_vector_register(unsigned reg, unsigned element);
+
+        //set the given element of the specified vector register to "value"
+        void set_vector_register(unsigned reg, unsigned element, float value);
+
+        //sets the vector length used by vector instructions (at most MAX_VECTOR_LENGTH)
+        void set_vector_length(unsigned length);
+
+        //enables/disables chaining between vector units (enabled by default)
+        void set_vector_chaining(bool enabled);
+
 	//returns the IPC
 	float get_IPC();
 
@@ -173,12 +445,90 @@ public:
 	//returns the number of stalls added by processor
 	unsigned get_stalls();
 
+	//returns the number of stalls of a given cause
+	unsigned get_stalls(stall_cause_t cause);
+
+	//prints the stall cycles per cause, and the instructions ranked by the stall cycles they caused
+	void print_stall_profile();
+
+	//prints the label regions ranked by cycles, followed by the program listing annotated with,
+	//for each instruction, its share of the issue cycles, retired count, average cycles per stage
+	//and average fetch-to-retire latency; instructions below "min_percent" are elided
+	void print_hot_spots(float min_percent=0.0);
+
+	//starts writing a pipeline trace in O3PipeView format (readable by the Konata viewer) to "filename":
+	//one record per retired instruction, in program order, with its fetch, decode, issue, execute,
+	//memory and retire cycles and the execution unit it used
+	void enable_pipeline_trace(const char *filename);
+
+	//flushes and closes the pipeline trace
+	void disable_pipeline_trace();
+
+	//starts the stack-distance analysis of the data accesses: every address accessed in MEM (every
+	//element of the vector loads and stores) is mapped to its "line_size"-byte line, giving in a single
+	//run the miss ratio of every LRU cache with that line size, fully associative or with up to
+	//"max_ways" ways and "max_sets" sets. Not available while replaying a trace (no addresses are computed)
+	void enable_reuse_analysis(unsigned line_size=32, unsigned max_ways=16, unsigned max_sets=1024);
+
+	//prints the miss ratios of the caches of increasing size measured by the stack-distance analysis
+	void print_reuse_analysis();
+
+	//stops the stack-distance analysis
+	void disable_reuse_analysis();
+
+	//(re)builds the statistics registry; to be invoked once the execution units have been configured
+	void register_stats();
+
+	//dumps the statistics to "filename" (JSON or CSV) at the end of each run, and every "interval"
+	//clock cycles if interval is not 0
+	void enable_stats_dump(const char *filename, stats_format_t format, unsigned interval=0);
+
+	//prints the statistics registry
+	void print_stats();
+
+	//starts the workload characterization, cheap enough to be left on: instructions retired per opcode,
+	//RAW dependency distance at retire (in fetched instructions, from the latest older writer of each
+	//source register), taken branches per opcode and address stride between successive executions of
+	//each static load and store (absolute, in bytes). The collectors are registered in the statistics
+	//registry ("mix.*", "branches.*", "deps.raw_distance", "memory.*_stride") so that they are dumped
+	//with the other statistics. While replaying a trace, branch outcomes and addresses are taken from
+	//the trace. reset() stops the profile
+	void enable_workload_profile();
+
+	//prints the instruction mix, the branch taken rates and the dependency-distance and stride histograms
+	void print_workload_profile();
+
 	//prints the content of the data memory within the specified address range
 	void print_memory(unsigned start_address, unsigned end_address);
 
+	//writes the data memory within the specified address range to "filename" as raw bytes
+	//(faster and more compact than print_memory for large ranges)
+	void dump_memory(const char *filename, unsigned start_address, unsigned end_address);
+
+	//copies "filename", a raw little-endian image (e.g. written by dump_data_image), into the data memory at base_address
+	void load_data_image(const char *filename, unsigned base_address);
+
+	//writes the whole data memory to "filename" as a raw image
+	void dump_data_image(const char *filename);
+
+	//maps "filename" into the data memory at base_address (a multiple of the page size) instead of copying it,
+	//so that the pages are only read when accessed; with shared=true the stores go through to the file,
+	//otherwise they stay private to the simulator (copy-on-write). The rest of the last page of the file reads as 0
+	void map_data_image(const char *filename, unsigned base_address, bool shared=false);
+
 	// writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness)
 	void write_memory(unsigned address, unsigned value);
 
+	//copies "size" bytes into the data memory at the specified address (e.g. the data segments of a program)
+	void write_memory_block(unsigned address, const unsigned char *bytes, unsigned size);
+
+	//returns a 64-bit digest of the machine state: register files, pipeline registers and data memory
+	//(the data memory part is maintained incrementally, so the cost does not depend on the memory size)
+	unsigned long long state_hash();
+
+	//returns the digest of the data memory only
+	unsigned long long memory_hash();
+
 	//prints the values of the registers 
 	void print_registers();
 
@@ -193,6 +543,9 @@ public:
 	//debug units
 	void debug_units();
 
+	//fetches the instruction at address "pc", going through the loop buffer when a hardware loop is active
+	instruction_t fetch_instruction(unsigned pc);
+
 };
 
 #endif /*SIM_PIPE_FP_H_*/
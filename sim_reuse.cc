@@ -0,0 +1,127 @@
+#include "sim_reuse.h"
+#include <stdlib.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+#define REUSE_MIN_CAPACITY 1024
+
+reuse_analyzer::reuse_analyzer(unsigned line_size, unsigned max_ways, unsigned max_sets) :
+	line_size(line_size), max_ways(max_ways), max_sets(max_sets), total_accesses(0), now(0){
+	if (line_size == 0 || (line_size & (line_size - 1)) || max_ways == 0 || max_sets == 0 || (max_sets & (max_sets - 1))){
+		cout << "ERROR:: the line size and the maximum number of sets must be powers of two, the maximum number of ways at least 1" << endl;
+		exit(-1);
+	}
+	tree.assign(REUSE_MIN_CAPACITY + 1, 0);
+	for (unsigned sets = 1; sets <= max_sets; sets *= 2){
+		stacks.push_back(vector<unsigned>(sets * max_ways, 0));
+		positions.push_back(vector<unsigned long long>(max_ways, 0));
+	}
+}
+
+/* ============================  Fenwick tree ============================= */
+
+void reuse_analyzer::mark(unsigned time, int delta){
+	for (unsigned i = time + 1; i < tree.size(); i += i & -i) tree[i] += delta;
+}
+
+/* marks at the times up to "time" included */
+unsigned long long reuse_analyzer::prefix(unsigned time){
+	unsigned long long sum = 0;
+	for (unsigned i = time + 1; i > 0; i -= i & -i) sum += tree[i];
+	return sum;
+}
+
+/* the tree is full: the times of the last accesses are renumbered 0 .. lines-1, keeping their order */
+void reuse_analyzer::compact(){
+	vector< pair<unsigned, unsigned> > order;
+	for (unordered_map<unsigned, unsigned>::iterator it = last_access.begin(); it != last_access.end(); it++)
+		order.push_back(make_pair(it->second, it->first));
+	sort(order.begin(), order.end());
+	unsigned capacity = max((unsigned)(2 * order.size()), (unsigned)REUSE_MIN_CAPACITY);
+	tree.assign(capacity + 1, 0);
+	for (unsigned t=0; t<order.size(); t++){
+		last_access[order[t].second] = t;
+		mark(t, 1);
+	}
+	now = order.size();
+}
+
+/* ============================  accesses ============================= */
+
+void reuse_analyzer::access(unsigned address){
+	unsigned line = address / line_size;
+	total_accesses++;
+
+	unordered_map<unsigned, unsigned>::iterator it = last_access.find(line);
+	if (it != last_access.end()){
+		//distinct lines accessed after the previous access to this line
+		unsigned distance = prefix(now - 1) - prefix(it->second);
+		if (distance >= distances.size()) distances.resize(distance + 1, 0);
+		distances[distance]++;
+		mark(it->second, -1);
+	}
+	if (now + 1 >= tree.size()){
+		if (it != last_access.end()) last_access.erase(it);
+		compact();
+		it = last_access.end();
+	}
+	mark(now, 1);
+	if (it != last_access.end()) it->second = now;
+	else last_access[line] = now;
+	now++;
+
+	for (unsigned level = 0; level < stacks.size(); level++){
+		unsigned *stack = &stacks[level][(line & ((1u << level) - 1)) * max_ways];
+		unsigned position = 0;
+		while (position < max_ways && stack[position] != line + 1) position++;
+		if (position < max_ways) positions[level][position]++;
+		else position = max_ways - 1;
+		for (; position > 0; position--) stack[position] = stack[position - 1];
+		stack[0] = line + 1;
+	}
+}
+
+/* ============================  results ============================= */
+
+double reuse_analyzer::miss_ratio(unsigned lines){
+	if (total_accesses == 0) return 0.0;
+	unsigned long long hits = 0;
+	for (unsigned d = 0; d < lines && d < distances.size(); d++) hits += distances[d];
+	return (double)(total_accesses - hits) / total_accesses;
+}
+
+double reuse_analyzer::miss_ratio(unsigned sets, unsigned ways){
+	unsigned level = 0;
+	while ((1u << level) < sets) level++;
+	if ((1u << level) != sets || level >= stacks.size() || ways == 0 || ways > max_ways){
+		cout << "ERROR:: the stack-distance analysis covers up to " << max_sets << " sets (powers of two) and " << max_ways << " ways" << endl;
+		exit(-1);
+	}
+	if (total_accesses == 0) return 0.0;
+	unsigned long long hits = 0;
+	for (unsigned p = 0; p < ways; p++) hits += positions[level][p];
+	return (double)(total_accesses - hits) / total_accesses;
+}
+
+void reuse_analyzer::print(){
+	ios_base::fmtflags flags = cout.flags();
+	char fill = cout.fill(' ');
+	cout << "Stack-distance analysis: " << dec << total_accesses << " accesses, " << lines() << " distinct " << line_size << "-byte lines" << endl;
+	cout << setw(10) << "size" << setw(10) << "full";
+	for (unsigned ways = 1; ways <= max_ways; ways *= 2) cout << setw(9) << ways << "w";
+	cout << endl << fixed << setprecision(4);
+	for (unsigned lines = 1; ; lines *= 2){
+		cout << setw(9) << (unsigned long long)lines * line_size << "B" << setw(10) << miss_ratio(lines);
+		for (unsigned ways = 1; ways <= max_ways; ways *= 2){
+			if (ways <= lines && lines / ways <= max_sets) cout << setw(10) << miss_ratio(lines / ways, ways);
+			else cout << setw(10) << "-";
+		}
+		cout << endl;
+		if (lines >= this->lines()) break;
+	}
+	cout.flags(flags);
+	cout.fill(fill);
+}
@@ -0,0 +1,63 @@
+#ifndef SIM_REUSE_H_
+#define SIM_REUSE_H_
+
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// stack-distance (reuse-distance) analysis of a stream of data addresses, at the granularity of
+// cache lines. In one pass it gives the miss ratio of every LRU cache with the given line size:
+// - fully associative: the stack distance of an access is the number of distinct lines accessed
+//   since the previous access to the same line, counted with a Fenwick tree over the time of the
+//   last access of every line; a cache of C lines misses on the first access to a line and on
+//   the accesses with distance >= C
+// - set associative: for every number of sets (powers of two up to "max_sets"), each set keeps its
+//   LRU stack, "max_ways" deep; a cache with S sets and W ways misses on the accesses whose
+//   position in the stack of their set is >= W
+class reuse_analyzer{
+public:
+	reuse_analyzer(unsigned line_size, unsigned max_ways, unsigned max_sets);
+
+	void access(unsigned address);
+
+	unsigned long long accesses() { return total_accesses; }
+
+	//distinct lines accessed (cold misses)
+	unsigned long long lines() { return last_access.size(); }
+
+	//accesses with each fully associative stack distance (the first accesses to a line excluded)
+	const vector<unsigned long long> &histogram() { return distances; }
+
+	//miss ratio of a fully associative LRU cache of "lines" lines
+	double miss_ratio(unsigned lines);
+
+	//miss ratio of an LRU cache with "sets" sets (a power of two up to max_sets) of "ways" ways (up to max_ways)
+	double miss_ratio(unsigned sets, unsigned ways);
+
+	//prints the miss ratios of the caches from one line to the smallest one holding all the lines,
+	//fully associative and with 1, 2, 4, ... max_ways ways
+	void print();
+
+private:
+	void compact();
+	void mark(unsigned time, int delta);
+	unsigned long long prefix(unsigned time);
+
+	unsigned line_size;
+	unsigned max_ways;
+	unsigned max_sets;
+	unsigned long long total_accesses;
+
+	//fully associative distances
+	unordered_map<unsigned, unsigned> last_access;   //line -> time of its last access
+	vector<unsigned> tree;                           //Fenwick tree: 1 at the time of the last access of every line
+	unsigned now;                                    //time of the next access (reset by compact)
+	vector<unsigned long long> distances;
+
+	//set-associative stacks, one level per number of sets
+	vector< vector<unsigned> > stacks;               //stacks[level][set * max_ways + position]: line + 1, 0 if empty
+	vector< vector<unsigned long long> > positions;  //positions[level][position]: hits at each stack position
+};
+
+#endif /*SIM_REUSE_H_*/
@@ -0,0 +1,127 @@
+#include "sim_sampling.h"
+#include <stdlib.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+sampling_config_t sampling_defaults(){
+	sampling_config_t config;
+	config.period = 1000;
+	config.warmup = 200;
+	config.window = 100;
+	config.target_error = 0.03;
+	config.z = 3.0;
+	config.max_passes = 4;
+	return config;
+}
+
+static bool program_ended(sim_pipe_fp *mips){
+	return mips->sim_pipe_pipeline_reg[WB].IR.opcode == EOP;
+}
+
+/* one sample: the detailed simulator, restarted from the architectural state of "functional", simulates
+   the warm-up and the measurement window; returns false if the program ends within the sample */
+static bool measure_sample(sim_pipe_fp *detailed, sim_pipe_fp *functional, const sampling_config_t &config,
+                           double &cpi, sampling_result_t &result){
+	detailed->restart_from(functional);
+	while (detailed->get_instructions_executed() < config.warmup && !program_ended(detailed)) detailed->run(1);
+	unsigned cycles = detailed->get_clock_cycles();
+	unsigned instructions = detailed->get_instructions_executed();
+	while (detailed->get_instructions_executed() < config.warmup + config.window && !program_ended(detailed)) detailed->run(1);
+	bool complete = (detailed->get_instructions_executed() >= config.warmup + config.window);
+	cpi = (double)(detailed->get_clock_cycles() - cycles) / (detailed->get_instructions_executed() - instructions);
+	result.detailed_instructions += detailed->get_instructions_executed();
+	result.detailed_cycles += detailed->get_clock_cycles();
+	return complete;
+}
+
+/* one pass over the program: a sample at the start of every period; returns the instructions of the program.
+   The same detailed simulator takes all the samples: once its memory has been made equal to the functional
+   one, each restart only copies back the lines either simulator wrote since the previous sample */
+static unsigned long long sampling_pass(sampling_setup_t setup, void *arg, const sampling_config_t &config, unsigned period,
+                                        vector<double> &samples, sampling_result_t &result){
+	sim_pipe_fp *functional = setup(arg);
+	sim_pipe_fp *detailed = setup(arg);
+	detailed->copy_architectural_state(functional);
+	functional->enable_write_tracking();
+	detailed->enable_write_tracking();
+	unsigned long long instructions = 0;
+	while (true){
+		double cpi;
+		if (measure_sample(detailed, functional, config, cpi, result)) samples.push_back(cpi);
+		unsigned executed = functional->fast_forward(period);
+		instructions += executed;
+		if (executed < period) break;
+	}
+	delete detailed;
+	delete functional;
+	return instructions;
+}
+
+sampling_result_t run_sampled(sampling_setup_t setup, void *arg, const sampling_config_t &config){
+	if (config.window == 0 || config.period < config.warmup + config.window){
+		cout << "ERROR:: the sampling period must cover the warm-up and a non-empty measurement window" << endl;
+		exit(-1);
+	}
+	sampling_result_t result;
+	result.passes = 0;
+	result.detailed_instructions = result.detailed_cycles = 0;
+	unsigned period = config.period;
+	vector<double> samples;
+
+	while (true){
+		samples.clear();
+		result.instructions = sampling_pass(setup, arg, config, period, samples, result);
+		result.passes++;
+		result.period = period;
+		result.samples = samples.size();
+
+		result.cpi = result.cpi_stddev = 0.0;
+		for (unsigned i=0; i<samples.size(); i++) result.cpi += samples[i];
+		if (!samples.empty()) result.cpi /= samples.size();
+		for (unsigned i=0; i<samples.size(); i++) result.cpi_stddev += (samples[i] - result.cpi) * (samples[i] - result.cpi);
+		if (samples.size() > 1) result.cpi_stddev = sqrt(result.cpi_stddev / (samples.size() - 1));
+		result.error = (samples.size() > 1) ? config.z * result.cpi_stddev / (sqrt((double)samples.size()) * result.cpi) : 1.0;
+
+		if (samples.empty() || result.error <= config.target_error || result.passes >= config.max_passes) break;
+		// samples needed for the target error with the observed coefficient of variation
+		unsigned next = period / 2;
+		if (samples.size() > 1){
+			double needed = ceil(pow(config.z * result.cpi_stddev / (result.cpi * config.target_error), 2));
+			next = (unsigned)(result.instructions / needed);
+		}
+		if (next < config.warmup + config.window) next = config.warmup + config.window;
+		if (next >= period) break;
+		period = next;
+	}
+
+	if (samples.empty()){
+		// program shorter than a sample: simulated in detail
+		sim_pipe_fp *detailed = setup(arg);
+		detailed->run();
+		result.instructions = detailed->get_instructions_executed();
+		result.cpi = (double)detailed->get_clock_cycles() / result.instructions;
+		result.cpi_stddev = result.error = 0.0;
+		result.detailed_instructions += detailed->get_instructions_executed();
+		result.detailed_cycles += detailed->get_clock_cycles();
+		delete detailed;
+	}
+	double half_width = result.error * result.cpi;
+	result.ipc = 1.0 / result.cpi;
+	result.ipc_low = 1.0 / (result.cpi + half_width);
+	result.ipc_high = (half_width < result.cpi) ? 1.0 / (result.cpi - half_width) : HUGE_VAL;
+	result.estimated_cycles = (unsigned long long)(result.cpi * result.instructions + 0.5);
+	return result;
+}
+
+void print_sampling_result(const sampling_result_t &result){
+	cout << "Sampled simulation: " << dec << result.passes << " pass(es), period " << result.period << " instructions, "
+	     << result.samples << " samples" << endl;
+	cout << "Instructions = " << result.instructions << " (" << result.detailed_instructions << " simulated in detail)" << endl;
+	cout << "CPI = " << result.cpi << " (standard deviation " << result.cpi_stddev << ")" << endl;
+	cout << "IPC = " << result.ipc << " [" << result.ipc_low << ", " << result.ipc_high << "] (error " << 100.0 * result.error << "%)" << endl;
+	cout << "Estimated clock cycles = " << result.estimated_cycles << endl;
+}
@@ -0,0 +1,52 @@
+#ifndef SIM_SAMPLING_H_
+#define SIM_SAMPLING_H_
+
+#include "sim_pipe_fp.h"
+
+// sampled simulation (SMARTS): the program is executed functionally (fast_forward) and, at the
+// start of every sampling period, a detailed simulator is started from the architectural state
+// reached so far; it simulates "warmup" instructions to fill the pipeline, then the CPI of the
+// next "window" instructions is measured. The CPI of the program is estimated from the mean of
+// the samples, with a confidence interval from their standard deviation. If the interval is wider
+// than the target error, the period is shortened to the number of samples the observed variation
+// requires and the program is sampled again.
+typedef struct{
+	unsigned period;        //instructions from the start of a sample to the start of the next one
+	unsigned warmup;        //detailed warm-up instructions of a sample (not measured)
+	unsigned window;        //measured instructions of a sample
+	double target_error;    //relative half-width of the confidence interval to reach, 0 to sample once
+	double z;               //confidence level, in standard deviations (3.0: 99.7%)
+	unsigned max_passes;    //passes allowed to reach the target error
+} sampling_config_t;
+
+typedef struct{
+	unsigned passes;                          //sampling passes over the program
+	unsigned period;                          //sampling period of the last pass
+	unsigned samples;                         //samples of the last pass
+	unsigned long long instructions;          //instructions of the program (functional count)
+	unsigned long long detailed_instructions; //instructions simulated in detail, over all passes
+	unsigned long long detailed_cycles;       //clock cycles simulated in detail, over all passes
+	double cpi;                               //mean CPI of the samples
+	double cpi_stddev;                        //standard deviation of the CPI of the samples
+	double error;                             //relative half-width of the confidence interval
+	double ipc;                               //estimated IPC, and its confidence interval
+	double ipc_low;
+	double ipc_high;
+	unsigned long long estimated_cycles;      //estimated clock cycles of the whole program
+} sampling_result_t;
+
+// instantiates and configures a simulator, with the program loaded and the data initialized;
+// invoked twice per pass (the functional simulator and the detailed one, restarted for every sample)
+typedef sim_pipe_fp *(*sampling_setup_t)(void *arg);
+
+// returns the default configuration: 1000-instruction period, 200 warm-up and 100 measured
+// instructions, 3% error at 99.7% confidence, at most 4 passes
+sampling_config_t sampling_defaults();
+
+// runs the sampled simulation of the program instantiated by "setup"
+sampling_result_t run_sampled(sampling_setup_t setup, void *arg, const sampling_config_t &config);
+
+// prints the result of a sampled simulation
+void print_sampling_result(const sampling_result_t &result);
+
+#endif /*SIM_SAMPLING_H_*/
@@ -0,0 +1,278 @@
+#include "sim_simpoint.h"
+#include <stdlib.h>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+using namespace std;
+
+bool is_branch(opcode_t opcode); //sim_pipe_fp.cc
+
+simpoint_config_t simpoint_defaults(){
+	simpoint_config_t config;
+	config.interval = 1000;
+	config.max_k = 10;
+	config.dimensions = 15;
+	config.seeds = 5;
+	config.seed = 1;
+	config.warmup = 200;
+	return config;
+}
+
+/* ============================  basic-block vectors ============================= */
+
+unsigned basic_blocks(sim_pipe_fp *mips, vector<unsigned> &block_of){
+	unsigned size = 0;
+	while (size < PROGRAM_SIZE - 1 && mips->instr_memory[size].opcode != EOP) size++;
+	size++;
+	vector<bool> leader(size, false);
+	leader[0] = true;
+	for (unsigned i=0; i<size; i++){
+		opcode_t opcode = mips->instr_memory[i].opcode;
+		if (is_branch(opcode)){
+			unsigned target = i + 1 + ((int)mips->instr_memory[i].immediate >> 2);
+			if (target < size) leader[target] = true;
+		}
+		if ((is_branch(opcode) || opcode == LOOP || opcode == ENDLOOP) && i + 1 < size) leader[i+1] = true;
+	}
+	for (map<string, unsigned>::iterator it = mips->labels.begin(); it != mips->labels.end(); it++)
+		if (it->second < size) leader[it->second] = true;
+	unsigned blocks = 0;
+	block_of.assign(size, 0);
+	for (unsigned i=0; i<size; i++){
+		if (leader[i]) blocks++;
+		block_of[i] = blocks - 1;
+	}
+	return blocks;
+}
+
+unsigned long long collect_bbv(sim_pipe_fp *mips, unsigned interval, vector< vector<unsigned> > &bbv){
+	vector<unsigned> block_of;
+	unsigned blocks = basic_blocks(mips, block_of);
+	unsigned long long executed = 0;
+	bbv.clear();
+	while (true){
+		// instruction executed next: ENDLOOP is folded by fast_forward
+		unsigned index = (mips->sim_pipe_pipeline_reg[IF].PC - mips->instr_base_address) / 4;
+		if (mips->instr_memory[index].opcode == ENDLOOP)
+			index = (mips->loop_counter > 1) ? (mips->loop_start - mips->instr_base_address) / 4 : index + 1;
+		if (index >= block_of.size() || mips->instr_memory[index].opcode == EOP) break;
+		if (mips->fast_forward(1) == 0) break;
+		if (executed % interval == 0) bbv.push_back(vector<unsigned>(blocks, 0));
+		bbv.back()[block_of[index]]++;
+		executed++;
+	}
+	return executed;
+}
+
+/* ============================  k-means clustering ============================= */
+
+typedef vector< vector<double> > points_t;
+
+/* linear congruential generator, so that the simulation points do not depend on the C library */
+static double next_random(unsigned long long &state){
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (double)(state >> 11) / (double)(1ULL << 53);
+}
+
+static double distance2(const vector<double> &a, const vector<double> &b){
+	double d = 0.0;
+	for (unsigned i=0; i<a.size(); i++) d += (a[i] - b[i]) * (a[i] - b[i]);
+	return d;
+}
+
+/* k-means from k distinct random points; returns the distortion (sum of the squared distances
+   of the points from their centroids) */
+static double kmeans(const points_t &points, unsigned k, unsigned long long &state, vector<unsigned> &assignment, points_t &centroids){
+	unsigned n = points.size();
+	vector<unsigned> chosen;
+	while (chosen.size() < k){
+		unsigned p = (unsigned)(next_random(state) * n);
+		bool duplicate = false;
+		for (unsigned c=0; c<chosen.size(); c++) duplicate = duplicate || (chosen[c] == p);
+		if (!duplicate) chosen.push_back(p);
+	}
+	centroids.clear();
+	for (unsigned c=0; c<k; c++) centroids.push_back(points[chosen[c]]);
+	assignment.assign(n, k);
+
+	bool changed = true;
+	for (unsigned iteration = 0; changed && iteration < 100; iteration++){
+		changed = false;
+		for (unsigned p=0; p<n; p++){
+			unsigned best = 0;
+			for (unsigned c=1; c<k; c++)
+				if (distance2(points[p], centroids[c]) < distance2(points[p], centroids[best])) best = c;
+			if (assignment[p] != best){
+				assignment[p] = best;
+				changed = true;
+			}
+		}
+		// empty clusters keep their centroid
+		points_t sum(k, vector<double>(points[0].size(), 0.0));
+		vector<unsigned> count(k, 0);
+		for (unsigned p=0; p<n; p++){
+			for (unsigned d=0; d<points[p].size(); d++) sum[assignment[p]][d] += points[p][d];
+			count[assignment[p]]++;
+		}
+		for (unsigned c=0; c<k; c++)
+			if (count[c]) for (unsigned d=0; d<sum[c].size(); d++) centroids[c][d] = sum[c][d] / count[c];
+	}
+	double distortion = 0.0;
+	for (unsigned p=0; p<n; p++) distortion += distance2(points[p], centroids[assignment[p]]);
+	return distortion;
+}
+
+/* Bayesian information criterion of a clustering (Pelleg and Moore, X-means) */
+static double bic(const points_t &points, unsigned k, const vector<unsigned> &assignment, double distortion){
+	double n = points.size(), dims = points[0].size();
+	double variance = (n > k) ? distortion / (n - k) : 0.0;
+	if (variance <= 1e-12) variance = 1e-12;
+	vector<unsigned> count(k, 0);
+	for (unsigned p=0; p<points.size(); p++) count[assignment[p]]++;
+	double likelihood = 0.0;
+	for (unsigned c=0; c<k; c++){
+		if (count[c] == 0) continue;
+		double r = count[c];
+		likelihood += -r / 2 * log(2 * M_PI) - r * dims / 2 * log(variance) - (r - k) / 2 + r * log(r) - r * log(n);
+	}
+	double parameters = (k - 1) + dims * k + 1;
+	return likelihood - parameters / 2 * log(n);
+}
+
+simpoints_t find_simpoints(sampling_setup_t setup, void *arg, const simpoint_config_t &config){
+	if (config.interval == 0 || config.max_k == 0 || config.dimensions == 0 || config.seeds == 0){
+		cout << "ERROR:: the interval, the number of clusters, of dimensions and of k-means runs must be at least 1" << endl;
+		exit(-1);
+	}
+	simpoints_t simpoints;
+	vector< vector<unsigned> > bbv;
+	sim_pipe_fp *mips = setup(arg);
+	vector<unsigned> block_of;
+	simpoints.blocks = basic_blocks(mips, block_of);
+	simpoints.instructions = collect_bbv(mips, config.interval, bbv);
+	delete mips;
+	simpoints.intervals = bbv.size();
+	simpoints.k = 0;
+	simpoints.cpi = 0.0;
+	simpoints.estimated_cycles = 0;
+	if (bbv.empty()) return simpoints;
+
+	// random projection of the normalized basic-block vectors
+	unsigned long long state = config.seed;
+	points_t projection(simpoints.blocks, vector<double>(config.dimensions));
+	for (unsigned b=0; b<simpoints.blocks; b++)
+		for (unsigned d=0; d<config.dimensions; d++) projection[b][d] = 2 * next_random(state) - 1;
+	points_t points(bbv.size(), vector<double>(config.dimensions, 0.0));
+	vector<unsigned> length(bbv.size(), 0);
+	for (unsigned i=0; i<bbv.size(); i++){
+		for (unsigned b=0; b<simpoints.blocks; b++) length[i] += bbv[i][b];
+		for (unsigned b=0; b<simpoints.blocks; b++)
+			if (bbv[i][b]) for (unsigned d=0; d<config.dimensions; d++) points[i][d] += projection[b][d] * bbv[i][b] / length[i];
+	}
+
+	// best clustering (least distortion over the runs) for every k, and its score
+	unsigned max_k = (config.max_k < points.size()) ? config.max_k : points.size();
+	vector< vector<unsigned> > assignments(max_k + 1);
+	vector<points_t> centroids(max_k + 1);
+	vector<double> scores(max_k + 1);
+	for (unsigned k=1; k<=max_k; k++){
+		double best = HUGE_VAL;
+		for (unsigned s=0; s<config.seeds; s++){
+			vector<unsigned> assignment;
+			points_t centroid;
+			double distortion = kmeans(points, k, state, assignment, centroid);
+			if (distortion < best){
+				best = distortion;
+				assignments[k] = assignment;
+				centroids[k] = centroid;
+			}
+		}
+		scores[k] = bic(points, k, assignments[k], best);
+	}
+	double low = scores[1], high = scores[1];
+	for (unsigned k=2; k<=max_k; k++){
+		if (scores[k] < low) low = scores[k];
+		if (scores[k] > high) high = scores[k];
+	}
+	unsigned k = 1;
+	while (scores[k] < low + 0.9 * (high - low)) k++;
+
+	// one simulation point per non-empty cluster: the interval closest to the centroid
+	simpoints.cluster.assign(points.size(), 0);
+	for (unsigned c=0; c<k; c++){
+		simpoint_t point;
+		point.interval = UNDEFINED;
+		point.cluster = simpoints.points.size();
+		point.weight = 0.0;
+		point.cpi = 0.0;
+		for (unsigned p=0; p<points.size(); p++){
+			if (assignments[k][p] != c) continue;
+			simpoints.cluster[p] = point.cluster;
+			point.weight += (double)length[p] / simpoints.instructions;
+			if (point.interval == UNDEFINED || distance2(points[p], centroids[k][c]) < distance2(points[point.interval], centroids[k][c]))
+				point.interval = p;
+		}
+		if (point.interval != UNDEFINED) simpoints.points.push_back(point);
+	}
+	simpoints.k = simpoints.points.size();
+	return simpoints;
+}
+
+/* ============================  detailed simulation ============================= */
+
+static bool program_ended(sim_pipe_fp *mips){
+	return mips->sim_pipe_pipeline_reg[WB].IR.opcode == EOP;
+}
+
+void simulate_simpoints(sampling_setup_t setup, void *arg, const simpoint_config_t &config, simpoints_t &simpoints){
+	// the points are visited in program order, so that a single functional simulation reaches all of them
+	vector<unsigned> order;
+	for (unsigned i=0; i<simpoints.points.size(); i++){
+		unsigned j = order.size();
+		order.push_back(i);
+		while (j > 0 && simpoints.points[order[j-1]].interval > simpoints.points[i].interval){
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = i;
+	}
+	// as for the sampled simulation, one detailed simulator is restarted at every point
+	sim_pipe_fp *functional = setup(arg);
+	sim_pipe_fp *detailed = setup(arg);
+	detailed->copy_architectural_state(functional);
+	functional->enable_write_tracking();
+	detailed->enable_write_tracking();
+	unsigned long long position = 0;
+	simpoints.cpi = 0.0;
+	for (unsigned i=0; i<order.size(); i++){
+		simpoint_t &point = simpoints.points[order[i]];
+		unsigned long long start = (unsigned long long)point.interval * config.interval;
+		unsigned long long skip = (start > config.warmup) ? start - config.warmup : 0;
+		if (skip > position) position += functional->fast_forward(skip - position);
+		unsigned warmup = start - position;
+
+		detailed->restart_from(functional);
+		while (detailed->get_instructions_executed() < warmup && !program_ended(detailed)) detailed->run(1);
+		unsigned cycles = detailed->get_clock_cycles();
+		unsigned instructions = detailed->get_instructions_executed();
+		while (detailed->get_instructions_executed() < warmup + config.interval && !program_ended(detailed)) detailed->run(1);
+		instructions = detailed->get_instructions_executed() - instructions;
+		point.cpi = instructions ? (double)(detailed->get_clock_cycles() - cycles) / instructions : 0.0;
+		simpoints.cpi += point.weight * point.cpi;
+	}
+	delete detailed;
+	delete functional;
+	simpoints.estimated_cycles = (unsigned long long)(simpoints.cpi * simpoints.instructions + 0.5);
+}
+
+void print_simpoints(const simpoints_t &simpoints){
+	cout << "Simulation points: " << dec << simpoints.k << " cluster(s), " << simpoints.intervals << " intervals, "
+	     << simpoints.instructions << " instructions, " << simpoints.blocks << " basic blocks" << endl;
+	for (unsigned i=0; i<simpoints.points.size(); i++){
+		cout << simpoints.points[i].interval << " " << simpoints.points[i].weight;
+		if (simpoints.points[i].cpi > 0.0) cout << " (CPI " << simpoints.points[i].cpi << ")";
+		cout << endl;
+	}
+	if (simpoints.estimated_cycles) cout << "Estimated clock cycles = " << simpoints.estimated_cycles << endl;
+}
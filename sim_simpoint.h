@@ -0,0 +1,67 @@
+#ifndef SIM_SIMPOINT_H_
+#define SIM_SIMPOINT_H_
+
+#include <vector>
+#include "sim_sampling.h"
+
+using namespace std;
+
+// phase analysis (SimPoint): the program is executed functionally and split into intervals of
+// "interval" instructions. Each interval is summarized by its basic-block vector (instructions
+// executed in each basic block of the program, normalized to the size of the interval); the
+// vectors are reduced to "dimensions" dimensions with a random projection and clustered with
+// k-means, for every number of clusters up to "max_k". The clustering chosen is the one with the
+// fewest clusters whose BIC score reaches 90% of the best score; the interval closest to the
+// centroid of each cluster is the simulation point of the cluster, and the fraction of the
+// instructions of the program falling in the cluster its weight.
+typedef struct{
+	unsigned interval;     //instructions per interval
+	unsigned max_k;        //maximum number of clusters
+	unsigned dimensions;   //dimensions of the random projection
+	unsigned seeds;        //k-means runs (random initial centroids) per number of clusters
+	unsigned seed;         //seed of the random projection and of the initial centroids
+	unsigned warmup;       //detailed warm-up instructions before each simulation point
+} simpoint_config_t;
+
+typedef struct{
+	unsigned interval;     //interval number (the interval starts at instruction interval * size)
+	unsigned cluster;      //cluster represented
+	double weight;         //fraction of the instructions of the program in the cluster
+	double cpi;            //CPI of the interval, simulated in detail (see simulate_simpoints)
+} simpoint_t;
+
+typedef struct{
+	unsigned long long instructions;  //instructions of the program
+	unsigned intervals;               //intervals of the program (the last one may be partial)
+	unsigned blocks;                  //basic blocks of the program
+	unsigned k;                       //clusters chosen
+	vector<unsigned> cluster;         //cluster of every interval
+	vector<simpoint_t> points;        //one simulation point per cluster
+	double cpi;                       //weighted CPI of the simulation points
+	unsigned long long estimated_cycles; //estimated clock cycles of the whole program
+} simpoints_t;
+
+// returns the default configuration: 1000-instruction intervals, up to 10 clusters, 15 dimensions,
+// 5 k-means runs per number of clusters, 200 warm-up instructions
+simpoint_config_t simpoint_defaults();
+
+// numbers the basic blocks of the program loaded in "mips" (leaders: the first instruction, the
+// targets of the branches, the instructions following a branch, LOOP or ENDLOOP); block_of[i] is
+// the basic block of the i-th instruction. Returns the number of basic blocks
+unsigned basic_blocks(sim_pipe_fp *mips, vector<unsigned> &block_of);
+
+// executes the program functionally and collects the basic-block vector of every interval
+// (bbv[interval][block] = instructions executed in the block); returns the instructions executed
+unsigned long long collect_bbv(sim_pipe_fp *mips, unsigned interval, vector< vector<unsigned> > &bbv);
+
+// finds the simulation points of the program instantiated by "setup"
+simpoints_t find_simpoints(sampling_setup_t setup, void *arg, const simpoint_config_t &config);
+
+// simulates every simulation point in detail (after "warmup" instructions) and extrapolates the
+// clock cycles of the whole program from the weighted CPI
+void simulate_simpoints(sampling_setup_t setup, void *arg, const simpoint_config_t &config, simpoints_t &simpoints);
+
+// prints the simulation points: "interval weight" lines, as SimPoint's .simpoints/.weights files
+void print_simpoints(const simpoints_t &simpoints);
+
+#endif /*SIM_SIMPOINT_H_*/
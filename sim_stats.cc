@@ -0,0 +1,232 @@
+#include "sim_stats.h"
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+sim_stats::sim_stats(){
+	file = NULL;
+	format = STATS_JSON;
+	dumps = 0;
+}
+
+sim_stats::~sim_stats(){
+	close();
+}
+
+int sim_stats::find(const string &name){
+	for (unsigned i=0; i<stats.size(); i++) if (stats[i].name == name) return i;
+	return -1;
+}
+
+void sim_stats::add_counter(const string &name, const string &description, const unsigned *value){
+	stat_t stat;
+	stat.name = name;
+	stat.description = description;
+	stat.kind = STAT_COUNTER;
+	stat.value = value;
+	stat.bucket_size = 0;
+	stat.samples = stat.sum = 0;
+	stat.numerator = stat.denominator = 0;
+	stats.push_back(stat);
+}
+
+unsigned sim_stats::add_histogram(const string &name, const string &description, unsigned num_buckets, unsigned bucket_size){
+	if (num_buckets == 0 || bucket_size == 0){
+		cout << "ERROR:: histogram " << name << " needs at least one bucket of size at least 1" << endl;
+		exit(-1);
+	}
+	stat_t stat;
+	stat.name = name;
+	stat.description = description;
+	stat.kind = STAT_HISTOGRAM;
+	stat.value = NULL;
+	stat.bucket_size = bucket_size;
+	stat.buckets.assign(num_buckets, 0);
+	stat.samples = stat.sum = 0;
+	stat.numerator = stat.denominator = 0;
+	stats.push_back(stat);
+	return stats.size() - 1;
+}
+
+void sim_stats::add_formula(const string &name, const string &description, const string &numerator, const string &denominator){
+	int n = find(numerator);
+	int d = find(denominator);
+	if (n < 0 || d < 0){
+		cout << "ERROR:: formula " << name << " refers to an unknown statistic" << endl;
+		exit(-1);
+	}
+	stat_t stat;
+	stat.name = name;
+	stat.description = description;
+	stat.kind = STAT_FORMULA;
+	stat.value = NULL;
+	stat.bucket_size = 0;
+	stat.samples = stat.sum = 0;
+	stat.numerator = n;
+	stat.denominator = d;
+	stats.push_back(stat);
+}
+
+void sim_stats::sample(unsigned histogram, unsigned value){
+	stat_t &stat = stats[histogram];
+	unsigned bucket = value / stat.bucket_size;
+	if (bucket >= stat.buckets.size()) bucket = stat.buckets.size() - 1;
+	stat.buckets[bucket]++;
+	stat.samples++;
+	stat.sum += value;
+}
+
+const vector<unsigned long long> &sim_stats::buckets(unsigned histogram){
+	return stats[histogram].buckets;
+}
+
+double sim_stats::evaluate(const stat_t &stat){
+	switch (stat.kind){
+		case STAT_COUNTER:
+			return *stat.value;
+		case STAT_HISTOGRAM:
+			return stat.samples ? (double)stat.sum / stat.samples : 0.0;
+		case STAT_FORMULA:{
+			double d = evaluate(stats[stat.denominator]);
+			return (d != 0.0) ? evaluate(stats[stat.numerator]) / d : 0.0;
+		}
+	}
+	return 0.0;
+}
+
+double sim_stats::value(const string &name){
+	int i = find(name);
+	return (i < 0) ? 0.0 : evaluate(stats[i]);
+}
+
+void sim_stats::clear(){
+	stats.clear();
+}
+
+void sim_stats::reset_histograms(){
+	for (unsigned i=0; i<stats.size(); i++){
+		if (stats[i].kind != STAT_HISTOGRAM) continue;
+		stats[i].buckets.assign(stats[i].buckets.size(), 0);
+		stats[i].samples = stats[i].sum = 0;
+	}
+}
+
+void sim_stats::open(const char *filename, stats_format_t format){
+	close();
+	file = fopen(filename, "w");
+	if (file == NULL){
+		cout << "ERROR:: cannot open statistics file " << filename << endl;
+		exit(-1);
+	}
+	this->format = format;
+	dumps = 0;
+	if (format == STATS_JSON) fprintf(file, "[");
+	else fprintf(file, "cycle,name,value\n");
+}
+
+bool sim_stats::is_open(){
+	return (file != NULL);
+}
+
+void sim_stats::close(){
+	if (file == NULL) return;
+	if (format == STATS_JSON) fprintf(file, "\n]\n");
+	fclose(file);
+	file = NULL;
+}
+
+void sim_stats::dump(unsigned cycle){
+	if (file == NULL) return;
+	if (format == STATS_JSON) dump_json(cycle);
+	else dump_csv(cycle);
+	dumps++;
+}
+
+static bool stat_name_less(const stat_t *a, const stat_t *b){
+	return a->name < b->name;
+}
+
+/* splits a hierarchical name into its levels */
+static vector<string> stat_path(const string &name){
+	vector<string> path;
+	size_t start = 0, dot;
+	while ((dot = name.find('.', start)) != string::npos){
+		path.push_back(name.substr(start, dot - start));
+		start = dot + 1;
+	}
+	path.push_back(name.substr(start));
+	return path;
+}
+
+/* one snapshot: {"cycle": N, "stats": {...}}, the hierarchy of names becomes nested objects */
+void sim_stats::dump_json(unsigned cycle){
+	vector<const stat_t*> sorted;
+	for (unsigned i=0; i<stats.size(); i++) sorted.push_back(&stats[i]);
+	stable_sort(sorted.begin(), sorted.end(), stat_name_less);
+
+	fprintf(file, "%s\n  {\"cycle\": %u, \"stats\": {", dumps ? "," : "", cycle);
+	vector<string> open_path;
+	bool first = true;
+	for (unsigned i=0; i<sorted.size(); i++){
+		vector<string> path = stat_path(sorted[i]->name);
+		unsigned common = 0;
+		while (common < open_path.size() && common < path.size() - 1 && open_path[common] == path[common]) common++;
+		while (open_path.size() > common){
+			fprintf(file, "}");
+			open_path.pop_back();
+			first = false;
+		}
+		for (unsigned l=common; l<path.size() - 1; l++){
+			fprintf(file, "%s\"%s\": {", first ? "" : ", ", path[l].c_str());
+			open_path.push_back(path[l]);
+			first = true;
+		}
+		fprintf(file, "%s\"%s\": ", first ? "" : ", ", path.back().c_str());
+		first = false;
+		if (sorted[i]->kind == STAT_HISTOGRAM){
+			fprintf(file, "{\"samples\": %llu, \"mean\": %.6g, \"bucket_size\": %u, \"buckets\": [", sorted[i]->samples, evaluate(*sorted[i]), sorted[i]->bucket_size);
+			for (unsigned b=0; b<sorted[i]->buckets.size(); b++) fprintf(file, "%s%llu", b ? ", " : "", sorted[i]->buckets[b]);
+			fprintf(file, "]}");
+		}else if (sorted[i]->kind == STAT_COUNTER){
+			fprintf(file, "%u", *sorted[i]->value);
+		}else{
+			fprintf(file, "%.6g", evaluate(*sorted[i]));
+		}
+	}
+	while (!open_path.empty()){
+		fprintf(file, "}");
+		open_path.pop_back();
+	}
+	fprintf(file, "}}");
+}
+
+void sim_stats::print(){
+	for (unsigned i=0; i<stats.size(); i++){
+		const stat_t &stat = stats[i];
+		char buffer[64];
+		if (stat.kind == STAT_HISTOGRAM) snprintf(buffer, sizeof(buffer), "%.6g (%llu samples)", evaluate(stat), stat.samples);
+		else if (stat.kind == STAT_COUNTER) snprintf(buffer, sizeof(buffer), "%u", *stat.value);
+		else snprintf(buffer, sizeof(buffer), "%.6g", evaluate(stat));
+		cout << stat.name << string(stat.name.size() < 40 ? 40 - stat.name.size() : 1, ' ') << buffer
+		     << string(strlen(buffer) < 24 ? 24 - strlen(buffer) : 1, ' ') << "# " << stat.description << endl;
+	}
+}
+
+/* one row per value: cycle,name,value (histogram buckets are name.bucket<i>) */
+void sim_stats::dump_csv(unsigned cycle){
+	for (unsigned i=0; i<stats.size(); i++){
+		const stat_t &stat = stats[i];
+		if (stat.kind == STAT_HISTOGRAM){
+			fprintf(file, "%u,%s.samples,%llu\n", cycle, stat.name.c_str(), stat.samples);
+			fprintf(file, "%u,%s.mean,%.6g\n", cycle, stat.name.c_str(), evaluate(stat));
+			for (unsigned b=0; b<stat.buckets.size(); b++) fprintf(file, "%u,%s.bucket%u,%llu\n", cycle, stat.name.c_str(), b, stat.buckets[b]);
+		}else if (stat.kind == STAT_COUNTER){
+			fprintf(file, "%u,%s,%u\n", cycle, stat.name.c_str(), *stat.value);
+		}else{
+			fprintf(file, "%u,%s,%.6g\n", cycle, stat.name.c_str(), evaluate(stat));
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef SIM_STATS_H_
+#define SIM_STATS_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef enum {STATS_JSON, STATS_CSV} stats_format_t;
+
+typedef enum {STAT_COUNTER, STAT_HISTOGRAM, STAT_FORMULA} stat_kind_t;
+
+// a registered statistic
+// - counters point to a variable owned by the model component that registered it
+// - histograms are owned by the registry (fixed-size buckets, the last one collects the overflow)
+// - formulas are the ratio of two other statistics (e.g. IPC = instructions / cycles)
+typedef struct{
+	string name;         //hierarchical name, levels separated by '.' (e.g. "exec_units.ADDER0.busy_cycles")
+	string description;
+	stat_kind_t kind;
+	const unsigned *value;
+	unsigned bucket_size;
+	vector<unsigned long long> buckets;
+	unsigned long long samples;
+	unsigned long long sum;
+	unsigned numerator;
+	unsigned denominator;
+} stat_t;
+
+class sim_stats{
+public:
+	sim_stats();
+	~sim_stats();
+
+	//registers a counter; "value" must stay valid as long as the registry is used
+	void add_counter(const string &name, const string &description, const unsigned *value);
+
+	//registers a histogram with "num_buckets" buckets of "bucket_size" values each; returns its id
+	unsigned add_histogram(const string &name, const string &description, unsigned num_buckets, unsigned bucket_size=1);
+
+	//registers a formula: the ratio of two statistics already registered
+	void add_formula(const string &name, const string &description, const string &numerator, const string &denominator);
+
+	//adds a sample to a histogram
+	void sample(unsigned histogram, unsigned value);
+
+	//returns the current value of a statistic (the mean for a histogram), 0 if not registered
+	double value(const string &name);
+
+	//removes all the statistics
+	void clear();
+
+	//returns the buckets of a histogram (the last one collects the overflow)
+	const vector<unsigned long long> &buckets(unsigned histogram);
+
+	//clears the samples of all the histograms
+	void reset_histograms();
+
+	//starts dumping to "filename" in the given format; each dump() appends a snapshot
+	void open(const char *filename, stats_format_t format);
+
+	//writes a snapshot of all the statistics, tagged with the current cycle
+	void dump(unsigned cycle);
+
+	//prints all the statistics, one per line: name, value and description
+	void print();
+
+	//closes the output file (JSON output is completed)
+	void close();
+
+	//true if open() has been called
+	bool is_open();
+
+private:
+	vector<stat_t> stats;
+	FILE *file;
+	stats_format_t format;
+	unsigned dumps;
+
+	int find(const string &name);
+	double evaluate(const stat_t &stat);
+	void dump_json(unsigned cycle);
+	void dump_csv(unsigned cycle);
+};
+
+#endif /*SIM_STATS_H_*/
@@ -0,0 +1,375 @@
+#include "sim_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+using namespace std;
+
+bool is_branch(opcode_t opcode); //sim_pipe_fp.cc
+bool is_memory(opcode_t opcode);
+
+/* on-disk structures (little-endian hosts only, as the data images) */
+typedef struct{
+	unsigned magic;
+	unsigned version;
+	unsigned base_address;   //base address of the program in the instruction memory
+	unsigned block_records;  //records per block (the last block may be shorter)
+} trace_header_t;
+
+typedef struct{
+	unsigned records;        //records in the block
+	unsigned encoded_bytes;  //size of the encoded records
+	unsigned stored_bytes;   //size of the block in the file
+	unsigned compressed;     //1 if the encoded records are compressed
+} trace_block_header_t;
+
+typedef struct{
+	unsigned long long index_offset;  //file offset of the index (one 64-bit offset per block)
+	unsigned long long records;
+	unsigned blocks;
+	unsigned magic;
+} trace_trailer_t;
+
+#define TRACE_REG_NONE 0xFF
+#define TRACE_FLAG_TAKEN 0x20
+#define TRACE_FLAG_SEQUENTIAL 0x40   //pc of the previous record + 4
+#define TRACE_FLAG_VALUE 0x80
+
+/* ============================  record encoding ============================= */
+
+static inline void put_varint(vector<unsigned char> &out, unsigned value){
+	while (value >= 0x80){
+		out.push_back((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(value);
+}
+
+static inline unsigned zigzag(int value){
+	return ((unsigned)value << 1) ^ (unsigned)(value >> 31);
+}
+
+static inline int unzigzag(unsigned value){
+	return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+/* encodes a block; the deltas restart from 0 in every block, so that blocks are self-contained */
+static void encode_block(const vector<trace_record_t> &records, vector<unsigned char> &out){
+	unsigned pc = 0, address = 0;
+	for (unsigned i=0; i<records.size(); i++){
+		const trace_record_t &r = records[i];
+		opcode_t opcode = (opcode_t)r.opcode;
+		bool value = is_memory(opcode) || is_branch(opcode) || (r.value != 0);
+		unsigned char flags = r.opcode | (r.taken ? TRACE_FLAG_TAKEN : 0) | (r.pc == pc + 4 ? TRACE_FLAG_SEQUENTIAL : 0) | (value ? TRACE_FLAG_VALUE : 0);
+		out.push_back(flags);
+		if (!(flags & TRACE_FLAG_SEQUENTIAL)) put_varint(out, zigzag(r.pc - (pc + 4)));
+		put_varint(out, (r.dest == TRACE_REG_NONE) ? 0 : r.dest + 1);
+		put_varint(out, (r.src1 == TRACE_REG_NONE) ? 0 : r.src1 + 1);
+		put_varint(out, (r.src2 == TRACE_REG_NONE) ? 0 : r.src2 + 1);
+		if (is_memory(opcode)){
+			put_varint(out, zigzag(r.value - address));
+			address = r.value;
+		}else if (is_branch(opcode)) put_varint(out, zigzag(r.value - (r.pc + 4)));
+		else if (value) put_varint(out, r.value);
+		pc = r.pc;
+	}
+}
+
+/* decoder of a block, checking every read against the end of the data */
+class block_decoder{
+public:
+	block_decoder(const unsigned char *data, unsigned size, const string &name) : p(data), end(data + size), name(name) {}
+
+	unsigned char byte(){
+		if (p >= end) corrupted();
+		return *p++;
+	}
+	unsigned varint(){
+		unsigned value = 0;
+		for (unsigned shift = 0; shift < 35; shift += 7){
+			unsigned char b = byte();
+			value |= (unsigned)(b & 0x7F) << shift;
+			if (!(b & 0x80)) return value;
+		}
+		corrupted();
+		return 0;
+	}
+	unsigned char reg(){
+		unsigned value = varint();
+		return (value == 0) ? TRACE_REG_NONE : value - 1;
+	}
+	void corrupted(){
+		cout << "ERROR:: corrupted trace " << name << endl;
+		exit(-1);
+	}
+
+private:
+	const unsigned char *p;
+	const unsigned char *end;
+	const string &name;
+};
+
+static void decode_block(const unsigned char *data, unsigned size, unsigned count, vector<trace_record_t> &records, const string &name){
+	block_decoder in(data, size, name);
+	unsigned pc = 0, address = 0;
+	records.resize(count);
+	for (unsigned i=0; i<count; i++){
+		trace_record_t &r = records[i];
+		unsigned char flags = in.byte();
+		r.opcode = flags & 0x1F;
+		r.taken = (flags & TRACE_FLAG_TAKEN) != 0;
+		r.pc = (flags & TRACE_FLAG_SEQUENTIAL) ? pc + 4 : pc + 4 + unzigzag(in.varint());
+		r.dest = in.reg();
+		r.src1 = in.reg();
+		r.src2 = in.reg();
+		r.value = 0;
+		opcode_t opcode = (opcode_t)r.opcode;
+		if (is_memory(opcode)){
+			r.value = address = address + unzigzag(in.varint());
+		}else if (is_branch(opcode)) r.value = r.pc + 4 + unzigzag(in.varint());
+		else if (flags & TRACE_FLAG_VALUE) r.value = in.varint();
+		r.pad[0] = r.pad[1] = r.pad[2] = 0;
+		pc = r.pc;
+	}
+}
+
+/* ============================  block compression ============================= */
+
+/* LZ77 with a 64KB window: a sequence is a token (literal length in the high nibble, match length - 4
+   in the low nibble, 15 meaning that more length bytes follow), the literals, and the 16-bit offset
+   and extra length bytes of the match; the last sequence has literals only */
+
+#define LZ_HASH_BITS 14
+#define LZ_MIN_MATCH 4
+#define LZ_WINDOW 65535
+
+static inline unsigned read32(const unsigned char *p){
+	unsigned value;
+	memcpy(&value, p, sizeof value);
+	return value;
+}
+
+static inline unsigned lz_hash(unsigned value){
+	return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void put_length(vector<unsigned char> &out, unsigned length){
+	for (; length >= 255; length -= 255) out.push_back(255);
+	out.push_back(length);
+}
+
+static void put_sequence(vector<unsigned char> &out, const unsigned char *literals, unsigned literal_length, unsigned offset, unsigned match_length){
+	unsigned match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+	out.push_back(((literal_length < 15 ? literal_length : 15) << 4) | (match_code < 15 ? match_code : 15));
+	if (literal_length >= 15) put_length(out, literal_length - 15);
+	out.insert(out.end(), literals, literals + literal_length);
+	if (match_length == 0) return;
+	out.push_back(offset & 0xFF);
+	out.push_back(offset >> 8);
+	if (match_code >= 15) put_length(out, match_code - 15);
+}
+
+static void lz_compress(const vector<unsigned char> &in, vector<unsigned char> &out){
+	vector<int> table(1 << LZ_HASH_BITS, -1);
+	const unsigned char *data = in.empty() ? NULL : &in[0];
+	unsigned size = in.size(), anchor = 0, i = 0;
+	while (i + LZ_MIN_MATCH <= size){
+		unsigned h = lz_hash(read32(data + i));
+		int candidate = table[h];
+		table[h] = i;
+		if (candidate >= 0 && i - candidate <= LZ_WINDOW && read32(data + candidate) == read32(data + i)){
+			unsigned length = LZ_MIN_MATCH;
+			while (i + length < size && data[candidate + length] == data[i + length]) length++;
+			put_sequence(out, data + anchor, i - anchor, i - candidate, length);
+			i += length;
+			anchor = i;
+		}else i++;
+	}
+	put_sequence(out, data + anchor, size - anchor, 0, 0);
+}
+
+static void lz_decompress(const unsigned char *in, unsigned size, vector<unsigned char> &out, unsigned expected, const string &name){
+	block_decoder src(in, size, name);
+	out.clear();
+	out.reserve(expected);
+	unsigned consumed = 0;
+	while (consumed < size){
+		unsigned char token = src.byte();
+		consumed++;
+		unsigned length = token >> 4, b;
+		if (length == 15) do { b = src.byte(); consumed++; length += b; } while (b == 255);
+		for (unsigned k=0; k<length; k++) out.push_back(src.byte());
+		consumed += length;
+		if (consumed == size) break;
+		unsigned offset = src.byte();
+		offset |= src.byte() << 8;
+		consumed += 2;
+		length = token & 0x0F;
+		if (length == 15) do { b = src.byte(); consumed++; length += b; } while (b == 255);
+		length += LZ_MIN_MATCH;
+		if (offset == 0 || offset > out.size()) src.corrupted();
+		for (unsigned k=0, from = out.size() - offset; k<length; k++) out.push_back(out[from + k]);
+	}
+	if (out.size() != expected) src.corrupted();
+}
+
+/* ============================  writer ============================= */
+
+instr_trace_writer::instr_trace_writer(const char *filename, unsigned base_address, unsigned block_records)
+	: block_records(block_records ? block_records : TRACE_BLOCK_RECORDS), records(0), done(false){
+	file = fopen(filename, "wb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open trace file " << filename << endl;
+		exit(-1);
+	}
+	trace_header_t header = {TRACE_MAGIC, TRACE_VERSION, base_address, this->block_records};
+	fwrite(&header, sizeof(header), 1, file);
+	block.reserve(this->block_records);
+	writer = thread(&instr_trace_writer::background_writer, this);
+}
+
+instr_trace_writer::~instr_trace_writer(){
+	if (!block.empty()) flush_block();
+	{
+		unique_lock<mutex> guard(lock);
+		done = true;
+	}
+	queue_changed.notify_all();
+	writer.join();
+	trace_trailer_t trailer;
+	trailer.index_offset = ftell(file);
+	trailer.records = records;
+	trailer.blocks = index.size();
+	trailer.magic = TRACE_MAGIC;
+	if (!index.empty()) fwrite(&index[0], sizeof(index[0]), index.size(), file);
+	fwrite(&trailer, sizeof(trailer), 1, file);
+	fclose(file);
+}
+
+void instr_trace_writer::write(const trace_record_t &record){
+	block.push_back(record);
+	records++;
+	if (block.size() == block_records) flush_block();
+}
+
+void instr_trace_writer::record(const instruction_t &instr, unsigned pc, unsigned value, bool taken){
+	trace_record_t r;
+	r.pc = pc;
+	r.value = value;
+	r.opcode = instr.opcode;
+	r.dest = (instr.dest < REGISTER_FILE_SIZE) ? instr.dest : TRACE_REG_NONE;
+	r.src1 = (instr.src1 < REGISTER_FILE_SIZE) ? instr.src1 : TRACE_REG_NONE;
+	r.src2 = (instr.src2 < REGISTER_FILE_SIZE) ? instr.src2 : TRACE_REG_NONE;
+	r.taken = taken;
+	r.pad[0] = r.pad[1] = r.pad[2] = 0;
+	write(r);
+}
+
+/* hands the block over to the background writer, waiting if too many blocks are queued */
+void instr_trace_writer::flush_block(){
+	unique_lock<mutex> guard(lock);
+	while (queue.size() >= TRACE_WRITER_QUEUE) queue_changed.wait(guard);
+	queue.push_back(vector<trace_record_t>());
+	queue.back().swap(block);
+	queue_changed.notify_all();
+	guard.unlock();
+	block.reserve(block_records);
+}
+
+void instr_trace_writer::background_writer(){
+	vector<trace_record_t> records;
+	vector<unsigned char> encoded, compressed;
+	while (true){
+		{
+			unique_lock<mutex> guard(lock);
+			while (queue.empty() && !done) queue_changed.wait(guard);
+			if (queue.empty()) return;
+			records.swap(queue.front());
+			queue.pop_front();
+		}
+		queue_changed.notify_all();
+		encoded.clear();
+		compressed.clear();
+		encode_block(records, encoded);
+		lz_compress(encoded, compressed);
+		bool use_compressed = compressed.size() < encoded.size();
+		const vector<unsigned char> &stored = use_compressed ? compressed : encoded;
+		trace_block_header_t header = {(unsigned)records.size(), (unsigned)encoded.size(), (unsigned)stored.size(), use_compressed};
+		index.push_back(ftell(file));
+		fwrite(&header, sizeof(header), 1, file);
+		if (!stored.empty()) fwrite(&stored[0], 1, stored.size(), file);
+	}
+}
+
+/* ============================  reader ============================= */
+
+instr_trace_reader::instr_trace_reader(const char *filename) : name(filename), current(UNDEFINED), position(0){
+	file = fopen(filename, "rb");
+	if (file == NULL){
+		cout << "ERROR:: cannot open trace file " << filename << endl;
+		exit(-1);
+	}
+	trace_header_t header;
+	trace_trailer_t trailer;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != TRACE_MAGIC || header.version != TRACE_VERSION){
+		cout << "ERROR:: " << filename << " is not an instruction trace" << endl;
+		exit(-1);
+	}
+	if (fseek(file, -(long)sizeof(trailer), SEEK_END) != 0 || fread(&trailer, sizeof(trailer), 1, file) != 1 || trailer.magic != TRACE_MAGIC){
+		cout << "ERROR:: trace " << filename << " has no index (the recording did not complete)" << endl;
+		exit(-1);
+	}
+	program_base_address = header.base_address;
+	block_records = header.block_records;
+	records = trailer.records;
+	index.resize(trailer.blocks);
+	if (trailer.blocks && (fseek(file, trailer.index_offset, SEEK_SET) != 0 || fread(&index[0], sizeof(index[0]), trailer.blocks, file) != trailer.blocks)){
+		cout << "ERROR:: corrupted trace " << filename << endl;
+		exit(-1);
+	}
+}
+
+instr_trace_reader::~instr_trace_reader(){
+	fclose(file);
+}
+
+void instr_trace_reader::load_block(unsigned number){
+	trace_block_header_t header;
+	vector<unsigned char> stored, encoded;
+	if (fseek(file, index[number], SEEK_SET) != 0 || fread(&header, sizeof(header), 1, file) != 1){
+		cout << "ERROR:: corrupted trace " << name << endl;
+		exit(-1);
+	}
+	stored.resize(header.stored_bytes);
+	if (header.stored_bytes && fread(&stored[0], 1, header.stored_bytes, file) != header.stored_bytes){
+		cout << "ERROR:: corrupted trace " << name << endl;
+		exit(-1);
+	}
+	if (header.compressed) lz_decompress(stored.empty() ? NULL : &stored[0], stored.size(), encoded, header.encoded_bytes, name);
+	else encoded.swap(stored);
+	decode_block(encoded.empty() ? NULL : &encoded[0], encoded.size(), header.records, block, name);
+	current = number;
+	position = 0;
+}
+
+bool instr_trace_reader::next(trace_record_t &record){
+	if (current == UNDEFINED || position == block.size()){
+		unsigned number = (current == UNDEFINED) ? 0 : current + 1;
+		if (number >= index.size()) return false;
+		load_block(number);
+	}
+	record = block[position++];
+	return true;
+}
+
+void instr_trace_reader::seek(unsigned long long record){
+	if (record >= records){
+		//positioned at the end of the trace
+		if (!index.empty()) load_block(index.size() - 1);
+		position = block.size();
+		return;
+	}
+	unsigned number = record / block_records;
+	if (number != current) load_block(number);
+	position = record % block_records;
+}
@@ -0,0 +1,93 @@
+#ifndef SIM_TRACE_H_
+#define SIM_TRACE_H_
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+// compressed instruction traces (written by record_trace, read by replay_trace).
+// The records are grouped in blocks of "block_records" records. Within a block, PCs are encoded as
+// deltas from the next sequential PC, effective addresses as deltas from the previous address and
+// next PCs of branches as deltas from the fall-through, all as zigzag varints; registers are varints.
+// The encoded block is then compressed with a byte-oriented LZ77 coder (kept as is if it does not
+// shrink). Blocks are self-contained and an index at the end of the file gives the position of
+// every block, so that a reader can seek to any record.
+//
+//   file:  header | block ... block | index (one entry per block) | trailer
+//   block: block header | encoded records, compressed or not
+#define TRACE_MAGIC 0x54465053         //"SPFT"
+#define TRACE_VERSION 2
+#define TRACE_BLOCK_RECORDS 65536      //default number of records per block
+#define TRACE_WRITER_QUEUE 4           //blocks waiting for the background writer, at most
+
+// writer of a trace: the records are buffered by the caller's thread and every full block is
+// encoded, compressed and written by a background thread. The trace is complete (index written,
+// file closed) once the writer is destroyed
+class instr_trace_writer{
+public:
+	instr_trace_writer(const char *filename, unsigned base_address, unsigned block_records = TRACE_BLOCK_RECORDS);
+	~instr_trace_writer();
+
+	void write(const trace_record_t &record);
+
+	//builds the record of an instruction executed at "pc" (see trace_record_t)
+	void record(const instruction_t &instr, unsigned pc, unsigned value, bool taken);
+
+	//records written so far
+	unsigned long long size() { return records; }
+
+private:
+	void flush_block();
+	void background_writer();
+
+	FILE *file;
+	unsigned block_records;
+	unsigned long long records;
+	vector<trace_record_t> block;            //block being filled
+	deque< vector<trace_record_t> > queue;   //full blocks waiting to be written
+	bool done;
+	mutex lock;
+	condition_variable queue_changed;
+	thread writer;
+	vector<unsigned long long> index;        //file offset of every block written
+};
+
+// streaming reader of a trace, with random access through the block index
+class instr_trace_reader{
+public:
+	instr_trace_reader(const char *filename);
+	~instr_trace_reader();
+
+	//base address of the program the trace was recorded with
+	unsigned base_address() { return program_base_address; }
+
+	//records in the trace
+	unsigned long long size() { return records; }
+
+	//reads the next record; returns false at the end of the trace
+	bool next(trace_record_t &record);
+
+	//moves to the given record (the next call to next() returns it)
+	void seek(unsigned long long record);
+
+private:
+	void load_block(unsigned number);
+
+	FILE *file;
+	string name;
+	unsigned program_base_address;
+	unsigned block_records;
+	unsigned long long records;
+	vector<unsigned long long> index;   //file offset of every block
+	vector<trace_record_t> block;       //decoded records of the current block
+	unsigned current;                   //current block (UNDEFINED before the first one is loaded)
+	unsigned position;                  //next record in the current block
+};
+
+#endif /*SIM_TRACE_H_*/
@@ -0,0 +1,41 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the data directives of the assembler: the array sorted by asm/sort.asm is
+   declared in its .data segment, so the data memory is not initialized by the test case */
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 4);
+
+	//loads program (and its data) in instruction memory at address 0x10000000
+	mips->load_program("asm/sort.asm", 0x10000000);
+
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	mips->print_memory(0xA000, 0xA030);
+	mips->print_memory(0xB000, 0xB030);
+
+	// runs program to completion
+	cout << "\nEXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run();
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+	mips->print_memory(0xA000, 0xA030);
+	mips->print_memory(0xB000, 0xB030);
+
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+
+	delete mips;
+}
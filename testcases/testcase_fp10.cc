@@ -0,0 +1,74 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for loop unrolling: each program is run as written, unrolled by 2 and 4, and unrolled and scheduled */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+void run_program(const char *filename, unsigned unroll, bool schedule){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+	mips->init_exec_unit(FMA, 6, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program(filename, 0x10000000);
+	if (unroll > 1) mips->unroll_loops(unroll);
+	if (schedule) mips->schedule_program();
+
+	//initialize data memory and registers
+	for (i = 0xA000, j=1; i<0xA030; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	for (i = 0xB000, j=1; i<0xB030; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+	mips->set_int_register(0,0);
+	mips->set_int_register(1,0xA000);
+	mips->set_int_register(4,1);
+	for (i=0; i<12; i++) mips->set_fp_register(i, (float)i);
+
+	// runs program to completion
+	mips->run();
+
+	cout << filename << " (unrolled by " << unroll << (schedule ? ", scheduled)" : ")") << endl;
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA030);
+	mips->print_memory(0xB000, 0xB030);
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl << endl;
+
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	const char *programs[] = {"asm/codefp_unroll.asm", "asm/codefp_fma.asm"};
+
+	for (unsigned p=0; p<sizeof(programs)/sizeof(programs[0]); p++){
+		run_program(programs[p], 1, false);
+		run_program(programs[p], 2, false);
+		run_program(programs[p], 4, false);
+		run_program(programs[p], 4, true);
+	}
+}
@@ -0,0 +1,61 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the pipeline trace: the program is run with the O3PipeView trace enabled,
+   and the first records of the trace are printed */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+	const char *trace = "testcase_fp14.trace";
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp.asm", 0x10000000);
+
+	//initialize data memory
+	for (i = 0xA000, j=0; i<0xA020; i+=4, j++) mips->write_memory(i,float2unsigned((float)j));
+
+	// runs program to completion with the trace enabled
+	mips->enable_pipeline_trace(trace);
+	mips->run();
+	mips->disable_pipeline_trace();
+
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl << endl;
+
+	// prints the first records and counts the records in the trace
+	ifstream fin(trace);
+	string line;
+	unsigned records = 0, lines = 0;
+	while (getline(fin, line)){
+		if (line.find("O3PipeView:fetch:") == 0) records++;
+		if (records <= 6) cout << line << endl;
+		lines++;
+	}
+	fin.close();
+	remove(trace);
+	cout << "..." << endl << "Trace records = " << records << " (" << lines << " lines)" << endl;
+
+	delete mips;
+}
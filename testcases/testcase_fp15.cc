@@ -0,0 +1,65 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the statistics registry: the same program is run with a JSON dump every 50
+   cycles and with a CSV dump at the end of the run; the registry and the dumps are printed */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+void print_file(const char *filename){
+	ifstream fin(filename);
+	string line;
+	while (getline(fin, line)) cout << line << endl;
+	fin.close();
+	remove(filename);
+}
+
+void run_program(stats_format_t format, unsigned interval){
+
+	unsigned i, j;
+	const char *filename = (format == STATS_JSON) ? "testcase_fp15.json" : "testcase_fp15.csv";
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp.asm", 0x10000000);
+
+	//initialize data memory
+	for (i = 0xA000, j=0; i<0xA020; i+=4, j++) mips->write_memory(i,float2unsigned((float)j));
+
+	// runs program to completion, dumping the statistics
+	mips->enable_stats_dump(filename, format, interval);
+	mips->run();
+
+	mips->print_stats();
+	cout << endl;
+
+	// the file is complete once the registry is closed
+	mips->stats.close();
+	print_file(filename);
+	cout << endl;
+
+	delete mips;
+}
+
+int main(int argc, char **argv){
+	run_program(STATS_JSON, 50);
+	run_program(STATS_CSV, 0);
+}
@@ -0,0 +1,89 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the data images: the data memory initialized with write_memory is dumped to an
+   image, which is then copied (load_data_image) and mapped (map_data_image, private and shared)
+   into new simulator instances; all of them must run the program to the same final memory */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+#define IMAGE "testcase_fp16.img"
+
+sim_pipe_fp *new_simulator(){
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp.asm", 0x10000000);
+	mips->set_fp_register(1, 0.0);
+	mips->set_int_register(4, 0);
+	return mips;
+}
+
+/* runs the program and prints the result; returns the final digest of the data memory */
+unsigned long long run_program(sim_pipe_fp *mips, const char *name, unsigned long long initial_digest){
+	cout << name << ": initial memory digest " << (mips->memory_hash() == initial_digest ? "matches" : "DIFFERS") << endl;
+	mips->run();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	return mips->memory_hash();
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	//reference: data memory initialized word by word, then dumped to an image
+	sim_pipe_fp *mips = new_simulator();
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j++) mips->write_memory(i, float2unsigned((float)j/2));
+	unsigned long long initial = mips->memory_hash(), digest;
+	mips->dump_data_image(IMAGE);
+	unsigned long long final = run_program(mips, "write_memory", initial);
+	cout << endl;
+	delete mips;
+
+	//the image copied into the data memory
+	mips = new_simulator();
+	mips->load_data_image(IMAGE, 0);
+	digest = run_program(mips, "load_data_image", initial);
+	cout << "final memory digest " << (digest == final ? "matches" : "DIFFERS") << endl << endl;
+	delete mips;
+
+	//the image mapped copy-on-write: the stores of the program do not reach the file
+	mips = new_simulator();
+	mips->map_data_image(IMAGE, 0);
+	digest = run_program(mips, "map_data_image (private)", initial);
+	cout << "final memory digest " << (digest == final ? "matches" : "DIFFERS") << endl << endl;
+	delete mips;
+
+	//the image mapped shared: the stores of the program are written to the file
+	mips = new_simulator();
+	mips->map_data_image(IMAGE, 0, true);
+	digest = run_program(mips, "map_data_image (shared)", initial);
+	cout << "final memory digest " << (digest == final ? "matches" : "DIFFERS") << endl << endl;
+	delete mips;
+
+	mips = new_simulator();
+	mips->load_data_image(IMAGE, 0);
+	cout << "image after the shared run: digest " << (mips->memory_hash() == final ? "matches the final memory" : "DIFFERS") << endl;
+	mips->reset();
+	cout << "after reset: memory digest " << (mips->memory_hash() == 0 ? "empty" : "NOT EMPTY") << endl;
+	delete mips;
+
+	remove(IMAGE);
+}
@@ -0,0 +1,50 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the data directives of the assembler: asm/codefp_data.asm is asm/codefp.asm
+   with its input array (.float) and its output area (.space) declared in .data segments,
+   so the data memory is not initialized by the test case */
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program (and its data) in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_data.asm", 0x10000000);
+	mips->set_fp_register(1, 0.0);
+	mips->set_int_register(4, 0);
+
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB030);
+
+	// runs program to completion
+	cout << "\nEXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run();
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB030);
+
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+
+	delete mips;
+}
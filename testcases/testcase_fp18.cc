@@ -0,0 +1,63 @@
+#include "sim_sampling.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the sampled simulation: a program with two phases (a floating point loop
+   with long dependence chains, then an integer loop) is simulated in detail and sampled;
+   the detailed IPC must lie in the confidence interval of the estimate, and the tighter
+   target error requires a second pass with a shorter period */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *new_simulator(void *arg){
+	unsigned i;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_phases.asm", 0x10000000);
+	for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+	for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+	mips->set_fp_register(1, 0.0);
+	return mips;
+}
+
+void check_estimate(const sampling_result_t &result, double ipc){
+	print_sampling_result(result);
+	cout << "detailed IPC " << (ipc >= result.ipc_low && ipc <= result.ipc_high ? "within" : "OUTSIDE") << " the confidence interval" << endl << endl;
+}
+
+int main(int argc, char **argv){
+
+	//reference: detailed simulation of the whole program
+	sim_pipe_fp *mips = new_simulator(NULL);
+	mips->run();
+	double ipc = (double)mips->get_instructions_executed() / mips->get_clock_cycles();
+	cout << "Detailed simulation: instructions = " << dec << mips->get_instructions_executed()
+	     << ", clock cycles = " << mips->get_clock_cycles() << ", IPC = " << ipc << endl << endl;
+	delete mips;
+
+	//one sample every 500 instructions: 100 warm-up and 50 measured instructions
+	sampling_config_t config = sampling_defaults();
+	config.period = 500;
+	config.warmup = 100;
+	config.window = 50;
+	config.target_error = 0.20;
+	check_estimate(run_sampled(new_simulator, NULL, config), ipc);
+
+	//tighter target error: the period is shortened to collect more samples
+	config.target_error = 0.10;
+	check_estimate(run_sampled(new_simulator, NULL, config), ipc);
+}
@@ -0,0 +1,67 @@
+#include "sim_simpoint.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <math.h>
+
+using namespace std;
+
+/* Test case for the phase analysis: the basic blocks of a program with two phases (a floating
+   point loop, then an integer loop) are listed, the basic-block vectors of its intervals are
+   clustered into simulation points, which are simulated in detail; the extrapolated clock
+   cycles are compared with the detailed simulation of the whole program */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *new_simulator(void *arg){
+	unsigned i;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_phases.asm", 0x10000000);
+	for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+	for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+	mips->set_fp_register(1, 0.0);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i;
+
+	//basic blocks of the program
+	sim_pipe_fp *mips = new_simulator(NULL);
+	vector<unsigned> block_of;
+	unsigned blocks = basic_blocks(mips, block_of);
+	cout << blocks << " basic blocks:";
+	for (i = 0; i < block_of.size(); i++) cout << " " << block_of[i];
+	cout << endl << endl;
+
+	//reference: detailed simulation of the whole program
+	mips->run();
+	unsigned cycles = mips->get_clock_cycles();
+	cout << "Detailed simulation: instructions = " << dec << mips->get_instructions_executed() << ", clock cycles = " << cycles << endl << endl;
+	delete mips;
+
+	//intervals of 200 instructions, 100 warm-up instructions before each simulation point
+	simpoint_config_t config = simpoint_defaults();
+	config.interval = 200;
+	config.warmup = 100;
+	simpoints_t simpoints = find_simpoints(new_simulator, NULL, config);
+	cout << "Cluster of the intervals:";
+	for (i = 0; i < simpoints.cluster.size(); i++) cout << " " << simpoints.cluster[i];
+	cout << endl;
+	simulate_simpoints(new_simulator, NULL, config, simpoints);
+	print_simpoints(simpoints);
+	cout << "Error = " << 100.0 * fabs((double)simpoints.estimated_cycles - cycles) / cycles << "%" << endl;
+}
@@ -0,0 +1,68 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the trace-driven replay: the instruction stream of a program with a hardware loop
+   is recorded once, then replayed with different execution units and memory latencies; the replay
+   must take the same clock cycles as the detailed simulation, without touching registers and data
+   memory */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+#define TRACE "testcase_fp20.trace"
+
+sim_pipe_fp *new_simulator(unsigned mem_latency, unsigned fp_latency, unsigned fp_units){
+	unsigned i, j;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, mem_latency);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, fp_latency, fp_units);
+	mips->init_exec_unit(MULTIPLIER, 2 * fp_latency, fp_units);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_loop.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j++) mips->write_memory(i, float2unsigned((float)j/2));
+	mips->set_fp_register(1, 0.0);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	sim_pipe_fp *mips = new_simulator(2, 4, 1);
+	cout << "Recorded instructions = " << dec << mips->record_trace(TRACE) << endl;
+	mips->print_memory(0xA000, 0xA024);
+	delete mips;
+
+	unsigned configurations[3][3] = {{2, 4, 1}, {0, 1, 2}, {10, 6, 1}};
+	for (unsigned c = 0; c < 3; c++){
+		cout << endl << "memory latency " << dec << configurations[c][0] << ", adder latency " << configurations[c][1]
+		     << ", " << configurations[c][2] << " adder(s)" << endl;
+		mips = new_simulator(configurations[c][0], configurations[c][1], configurations[c][2]);
+		mips->run();
+		cout << "detailed: clock cycles = " << dec << mips->get_clock_cycles() << ", instructions = " << mips->get_instructions_executed()
+		     << ", stalls = " << mips->get_stalls() << endl;
+		delete mips;
+
+		mips = new_simulator(configurations[c][0], configurations[c][1], configurations[c][2]);
+		unsigned long long digest = mips->memory_hash();
+		mips->replay_trace(TRACE);
+		mips->run();
+		cout << "replay:   clock cycles = " << dec << mips->get_clock_cycles() << ", instructions = " << mips->get_instructions_executed()
+		     << ", stalls = " << mips->get_stalls() << endl;
+		cout << "data memory " << (mips->memory_hash() == digest ? "unchanged" : "MODIFIED") << ", F1 = " << mips->get_fp_register(1)
+		     << ", R2 = " << mips->get_int_register(2) << " after the replay" << endl;
+		delete mips;
+	}
+
+	remove(TRACE);
+}
@@ -0,0 +1,96 @@
+#include "sim_trace.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* Test case for the compressed trace format: the trace of a program with two phases is copied
+   into a trace with small blocks; both are read back sequentially and at random positions through
+   the block index and must match the records of the original, and the copy is replayed */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+#define TRACE "testcase_fp21.trace"
+#define COPY "testcase_fp21_copy.trace"
+
+sim_pipe_fp *new_simulator(){
+	unsigned i;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_phases.asm", 0x10000000);
+	for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+	for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+	mips->set_fp_register(1, 0.0);
+	return mips;
+}
+
+unsigned file_size(const char *filename){
+	struct stat info;
+	return (stat(filename, &info) == 0) ? info.st_size : 0;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i;
+	trace_record_t record;
+	vector<trace_record_t> records;
+
+	sim_pipe_fp *mips = new_simulator();
+	cout << "Recorded instructions = " << dec << mips->record_trace(TRACE) << endl;
+	delete mips;
+
+	//sequential read and copy into blocks of 1000 records
+	instr_trace_reader *trace = new instr_trace_reader(TRACE);
+	instr_trace_writer *copy = new instr_trace_writer(COPY, trace->base_address(), 1000);
+	while (trace->next(record)){
+		records.push_back(record);
+		copy->write(record);
+	}
+	cout << "Records = " << trace->size() << " (" << records.size() << " read), " << file_size(TRACE) << " bytes ("
+	     << sizeof(trace_record_t) * records.size() << " bytes uncompressed)" << endl;
+	delete copy;
+	delete trace;
+
+	trace = new instr_trace_reader(COPY);
+	bool match = (trace->size() == records.size());
+	for (i = 0; trace->next(record); i++) match = match && (i < records.size()) && !memcmp(&record, &records[i], sizeof(record));
+	cout << "Copy: " << file_size(COPY) << " bytes, sequential read " << (match && i == records.size() ? "matches" : "DIFFERS") << endl;
+
+	//random accesses, in and across blocks
+	unsigned positions[] = {0, 999, 1000, 12293, 5432, 5433, 7, 11111, 12294, 12295};
+	for (unsigned p = 0; p < sizeof(positions)/sizeof(positions[0]); p++){
+		trace->seek(positions[p]);
+		if (!trace->next(record)) cout << "record " << positions[p] << ": end of the trace" << endl;
+		else cout << "record " << positions[p] << ": pc 0x" << hex << record.pc << " value 0x" << record.value << dec << " "
+		          << (!memcmp(&record, &records[positions[p]], sizeof(record)) ? "matches" : "DIFFERS") << endl;
+	}
+	delete trace;
+
+	//replay of the copy
+	mips = new_simulator();
+	mips->run();
+	cout << "Detailed simulation: clock cycles = " << mips->get_clock_cycles() << endl;
+	delete mips;
+	mips = new_simulator();
+	mips->replay_trace(COPY);
+	mips->run();
+	cout << "Replay: clock cycles = " << mips->get_clock_cycles() << endl;
+	delete mips;
+
+	remove(TRACE);
+	remove(COPY);
+}
@@ -0,0 +1,84 @@
+#include "sim_pipe_fp.h"
+#include "sim_reuse.h"
+#include <iostream>
+#include <list>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the stack-distance analysis: the miss ratios computed in one pass over an address
+   stream must match the ones of a direct simulation of each LRU cache (the stream is long enough
+   to compact the Fenwick tree several times); then the analysis of the data accesses of the sort
+   program is printed */
+
+/* direct simulation of an LRU cache of "sets" sets of "ways" lines: returns the misses */
+unsigned long long simulate_cache(const vector<unsigned> &addresses, unsigned line_size, unsigned sets, unsigned ways){
+	vector< list<unsigned> > cache(sets);
+	unsigned long long misses = 0;
+	for (unsigned i=0; i<addresses.size(); i++){
+		unsigned line = addresses[i] / line_size;
+		list<unsigned> &set = cache[line % sets];
+		list<unsigned>::iterator it = set.begin();
+		while (it != set.end() && *it != line) it++;
+		if (it == set.end()){
+			misses++;
+			if (set.size() == ways) set.pop_back();
+		} else set.erase(it);
+		set.push_front(line);
+	}
+	return misses;
+}
+
+int main(int argc, char **argv){
+
+	// address stream: a small hot region, a larger warm one and sequential sweeps
+	vector<unsigned> addresses;
+	unsigned long long state = 1;
+	for (unsigned i=0; i<60000; i++){
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		unsigned r = (unsigned)(state >> 33);
+		if (r % 4 == 0) addresses.push_back(0x1000 + (r / 4) % 0x200);
+		else if (r % 4 == 1) addresses.push_back(0x8000 + (r / 4) % 0x4000);
+		else addresses.push_back(0x20000 + (i * 4) % 0x10000);
+	}
+	unsigned line_size = 32;
+	reuse_analyzer analyzer(line_size, 16, 256);
+	for (unsigned i=0; i<addresses.size(); i++) analyzer.access(addresses[i]);
+
+	unsigned checked = 0, mismatches = 0;
+	for (unsigned lines = 1; lines <= 4096; lines *= 2){
+		double expected = (double)simulate_cache(addresses, line_size, 1, lines) / addresses.size();
+		checked++;
+		if (expected != analyzer.miss_ratio(lines)){
+			mismatches++;
+			cout << "fully associative, " << lines << " lines: " << analyzer.miss_ratio(lines) << " instead of " << expected << endl;
+		}
+		for (unsigned ways = 1; ways <= 16 && ways <= lines; ways *= 2){
+			if (lines / ways > 256) continue;
+			expected = (double)simulate_cache(addresses, line_size, lines / ways, ways) / addresses.size();
+			checked++;
+			if (expected != analyzer.miss_ratio(lines / ways, ways)){
+				mismatches++;
+				cout << lines / ways << " sets, " << ways << " ways: " << analyzer.miss_ratio(lines / ways, ways) << " instead of " << expected << endl;
+			}
+		}
+	}
+	cout << "Synthetic stream: " << analyzer.accesses() << " accesses, " << analyzer.lines() << " lines, "
+	     << checked << " caches checked, " << mismatches << " mismatches" << endl << endl;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000 (its data section initializes the array)
+	mips->load_program("asm/sort.asm", 0x10000000);
+	mips->enable_reuse_analysis(8, 4, 4);
+	mips->run();
+	mips->print_memory(0xB000, 0xB028);
+	mips->print_reuse_analysis();
+
+	delete mips;
+}
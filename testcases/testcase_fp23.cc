@@ -0,0 +1,61 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the dataflow limit study: each program is simulated in detail and analyzed on a
+   second instance; the analysis must cover the same instructions and its critical path must not
+   exceed the clock cycles of the pipeline. The analysis of the two-phase program is printed */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *new_simulator(const char *program){
+	unsigned i, j;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+	mips->init_exec_unit(VECTOR_ADDER, 4, 1);
+	mips->init_exec_unit(VECTOR_MULTIPLIER, 6, 1);
+	mips->init_exec_unit(VECTOR_MEMORY, 1, 1);
+	mips->set_vector_length(4);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program(program, 0x10000000);
+	if (strcmp(program, "asm/vector.asm") == 0){
+		for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j));
+		for (i = 0xB000, j=1; i<0xB010; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	}else if (strcmp(program, "asm/codefp_phases.asm") == 0){
+		for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+		for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+		mips->set_fp_register(1, 0.0);
+	}
+	return mips;
+}
+
+int main(int argc, char **argv){
+	const char *programs[] = {"asm/sort.asm", "asm/vector.asm", "asm/codefp_loop.asm", "asm/codefp_phases.asm"};
+
+	for (unsigned p=0; p<4; p++){
+		sim_pipe_fp *mips = new_simulator(programs[p]);
+		mips->run();
+		sim_pipe_fp *limit = new_simulator(programs[p]);
+		unsigned instructions = limit->analyze_dataflow();
+		cout << programs[p] << ": instructions = " << dec << mips->get_instructions_executed() << " / " << instructions
+		     << ", clock cycles = " << mips->get_clock_cycles() << ", critical path = " << limit->get_critical_path()
+		     << ", IPC = " << mips->get_IPC() << ", ideal IPC = " << limit->get_ideal_IPC()
+		     << ((limit->get_critical_path() <= mips->get_clock_cycles()) ? "" : " BOUND EXCEEDED") << endl;
+		if (p == 3) limit->print_dataflow_analysis(5);
+		delete mips;
+		delete limit;
+	}
+}
@@ -0,0 +1,73 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the workload profile: instruction mix, branch taken rates, RAW dependency
+   distances and strides of the sort program and of the two-phase program; the profile of a
+   trace replay must be the same as the one of the detailed simulation */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *new_simulator(const char *program){
+	unsigned i;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program(program, 0x10000000);
+	if (strcmp(program, "asm/codefp_phases.asm") == 0){
+		for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+		for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+		mips->set_fp_register(1, 0.0);
+	}
+	return mips;
+}
+
+/* runs the program with the workload profile and returns the printed profile */
+string profile(sim_pipe_fp *mips){
+	mips->enable_workload_profile();
+	mips->run();
+	stringstream output;
+	streambuf *saved = cout.rdbuf(output.rdbuf());
+	mips->print_workload_profile();
+	cout.rdbuf(saved);
+	return output.str();
+}
+
+int main(int argc, char **argv){
+
+	sim_pipe_fp *mips = new_simulator("asm/sort.asm");
+	cout << profile(mips);
+	cout << "BNEZ taken rate (registry) = " << mips->stats.value("branches.BNEZ.taken_rate") << endl << endl;
+	delete mips;
+
+	mips = new_simulator("asm/codefp_phases.asm");
+	string detailed = profile(mips);
+	cout << detailed;
+	delete mips;
+
+	//replay of the same program
+	mips = new_simulator("asm/codefp_phases.asm");
+	unsigned recorded = mips->record_trace("bin/testcase_fp24.trace");
+	delete mips;
+	mips = new_simulator("asm/codefp_phases.asm");
+	mips->replay_trace("bin/testcase_fp24.trace");
+	string replayed = profile(mips);
+	cout << endl << recorded << " instructions replayed: profile " << ((replayed == detailed) ? "identical" : "DIFFERENT") << endl;
+	if (replayed != detailed) cout << replayed;
+	delete mips;
+	remove("bin/testcase_fp24.trace");
+}
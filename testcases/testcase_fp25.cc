@@ -0,0 +1,111 @@
+#include "sim_dse.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the design-space search: the Pareto front of IPC versus area of the two-phase
+   program must be the one found by simulating every configuration; a second search with an IPC
+   target reuses the simulated IPCs through the cache file */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *new_simulator(const dse_point_t &point, void *arg){
+	unsigned i;
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, point.memory_latency);
+	init_exec_units(mips, point);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp_phases.asm", 0x10000000);
+	for (i = 0xA000; i < 0xB000; i += 4) mips->write_memory(i, float2unsigned((float)(i - 0xA000)/16));
+	for (i = 1; i < 6; i++) mips->set_int_register(i, 0);
+	mips->set_fp_register(1, 0.0);
+	return mips;
+}
+
+/* area: a unit costs more the faster it is; the memory cost falls with its latency */
+double area(const dse_point_t &point, void *arg){
+	static const double unit_area[NUM_UNIT_TYPES] = {1.0, 3.0, 8.0, 10.0, 6.0, 16.0, 4.0, 12.0};
+	double cost = 0.0;
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++) cost += point.units[t] * unit_area[t] * (1.0 + 4.0 / (point.latency[t] + 1));
+	return cost + 16.0 / point.memory_latency;
+}
+
+int main(int argc, char **argv){
+	dse_space_t space;
+	unsigned integer_units[] = {1}, integer_latency[] = {0, 1};
+	unsigned adder_units[] = {1, 2}, adder_latency[] = {2, 4};
+	unsigned multiplier_units[] = {1}, multiplier_latency[] = {4, 9};
+	unsigned divider_units[] = {0, 1}, divider_latency[] = {19};
+	unsigned memory_latency[] = {1, 2, 4};
+	space.units[INTEGER].assign(integer_units, integer_units + 1);
+	space.latency[INTEGER].assign(integer_latency, integer_latency + 2);
+	space.units[ADDER].assign(adder_units, adder_units + 2);
+	space.latency[ADDER].assign(adder_latency, adder_latency + 2);
+	space.units[MULTIPLIER].assign(multiplier_units, multiplier_units + 1);
+	space.latency[MULTIPLIER].assign(multiplier_latency, multiplier_latency + 2);
+	space.units[DIVIDER].assign(divider_units, divider_units + 2);
+	space.latency[DIVIDER].assign(divider_latency, divider_latency + 1);
+	space.memory_latency.assign(memory_latency, memory_latency + 3);
+
+	dse_config_t config = dse_defaults();
+	config.threads = 4;
+	config.cache = "bin/testcase_fp25.cache";
+	remove(config.cache);
+	dse_result_t result = explore_design_space(new_simulator, area, NULL, space, config);
+	print_design_space_result(result);
+
+	// reference: front of the whole grid
+	unsigned on_front = 0, mismatches = 0;
+	vector<dse_design_t> all;
+	for (unsigned i=0; i<1; i++) for (unsigned j=0; j<2; j++) for (unsigned k=0; k<2; k++) for (unsigned l=0; l<2; l++)
+	for (unsigned a=0; a<1; a++) for (unsigned b=0; b<2; b++) for (unsigned c=0; c<2; c++) for (unsigned m=0; m<3; m++){
+		dse_point_t point;
+		memset(&point, 0, sizeof(point));
+		point.units[INTEGER] = integer_units[i];
+		point.latency[INTEGER] = integer_latency[j];
+		point.units[ADDER] = adder_units[k];
+		point.latency[ADDER] = adder_latency[l];
+		point.units[MULTIPLIER] = multiplier_units[a];
+		point.latency[MULTIPLIER] = multiplier_latency[b];
+		point.units[DIVIDER] = divider_units[c];
+		point.latency[DIVIDER] = divider_units[c] ? divider_latency[0] : 0;
+		point.memory_latency = memory_latency[m];
+		sim_pipe_fp *mips = new_simulator(point, NULL);
+		mips->run();
+		dse_design_t design = {point, area(point, NULL), mips->get_IPC()};
+		all.push_back(design);
+		delete mips;
+	}
+	for (unsigned p=0; p<all.size(); p++){
+		// on the front: no configuration as cheap with a higher IPC, nor a cheaper one with the same IPC
+		bool dominated = false;
+		for (unsigned q=0; q<all.size() && !dominated; q++)
+			dominated = (all[q].cost <= all[p].cost && all[q].ipc > all[p].ipc) || (all[q].cost < all[p].cost && all[q].ipc >= all[p].ipc);
+		if (dominated) continue;
+		on_front++;
+		bool found = false;
+		for (unsigned r=0; r<result.pareto.size(); r++)
+			found = found || (result.pareto[r].cost == all[p].cost && result.pareto[r].ipc == all[p].ipc);
+		if (!found){
+			mismatches++;
+			cout << "missing from the front: " << point_text(all[p].point) << " cost " << all[p].cost << " IPC " << all[p].ipc << endl;
+		}
+	}
+	cout << "Exhaustive search: " << all.size() << " configurations simulated, " << on_front << " on the front, "
+	     << mismatches << " missing" << endl << endl;
+
+	// cheapest configuration reaching an IPC target, from the cache of the first search
+	config.ipc_target = 0.3;
+	result = explore_design_space(new_simulator, area, NULL, space, config);
+	print_design_space_result(result);
+	remove(config.cache);
+}
@@ -0,0 +1,71 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the static list scheduler: each program is run as written and after schedule_program() */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+void run_program(const char *filename, bool schedule){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+	mips->init_exec_unit(FMA, 6, 1);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program(filename, 0x10000000);
+	if (schedule) mips->schedule_program();
+
+	//initialize data memory and registers
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	for (i = 0xB000, j=1; i<0xB020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+	mips->set_int_register(0,0);
+	mips->set_int_register(1,0xA000);
+	mips->set_int_register(4,1);
+	for (i=0; i<12; i++) mips->set_fp_register(i, (float)i);
+
+	// runs program to completion
+	mips->run();
+
+	cout << filename << (schedule ? " (scheduled)" : " (as written)") << endl;
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl << endl;
+
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	const char *programs[] = {"asm/codefp.asm", "asm/codefp0.asm", "asm/codefp1.asm", "asm/codefp2.asm", "asm/codefp3.asm", "asm/codefp_fma.asm"};
+
+	for (unsigned p=0; p<sizeof(programs)/sizeof(programs[0]); p++){
+		run_program(programs[p], false);
+		run_program(programs[p], true);
+	}
+}
@@ -0,0 +1,271 @@
+/* Host-throughput benchmark for the simulators.
+ *
+ * The same source is compiled twice: as is for sim_pipe (bin/bench_sim_pipe) and with
+ * -DBENCH_FP for sim_pipe_fp (bin/bench_sim_pipe_fp); the two simulators define the same
+ * global symbols and cannot be linked in the same binary.
+ *
+ * Each kernel is simulated back to back (new instance, load, initialize the data, run to
+ * EOP) until at least the target number of simulated cycles has been reached; that is one
+ * repetition. After the warm-up repetitions, each measured repetition yields a simulated
+ * cycles/second and an instructions/second figure; the mean, standard deviation, minimum and
+ * maximum over the repetitions are reported on stdout as JSON. Only the time spent in run() is
+ * measured. Generated workloads are loaded together with their data image (<kernel>.img).
+ *
+ * With -s (sim_pipe_fp only), each kernel is also simulated whole, instantiation included, in detail
+ * and with the default sampling (see sim_sampling.h); the fastest of the repetitions are reported,
+ * and the benchmark fails if sampling is not faster for a kernel whose detailed simulation takes at
+ * least SAMPLING_MIN_RATIO times as long as instantiating the simulator (the sampling instantiates two
+ * simulators per pass, which dominates on the shortest kernels).
+ *
+ * usage: bench [-c cycles] [-w warmup] [-r repetitions] [-s] [kernel.asm ...]
+ * (the default kernels include the workloads generated by "make workloads" in bin/workloads)
+ */
+
+#ifdef BENCH_FP
+#include "sim_pipe_fp.h"
+#include "sim_sampling.h"
+#define SIMULATOR_NAME "sim_pipe_fp"
+#define SIMULATOR_OPTIONS " [-s]"
+typedef sim_pipe_fp simulator_t;
+#else
+#include "sim_pipe.h"
+#define SIMULATOR_NAME "sim_pipe"
+#define SIMULATOR_OPTIONS ""
+typedef sim_pipe simulator_t;
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define WORKLOAD_DATA_BASE 0xA000   //default base address of the gen_workload data images
+#define SAMPLING_MIN_RATIO 10        //shortest kernel checked by -s, in instantiation times
+
+#ifdef BENCH_FP
+static const char *default_kernels[] = {"asm/codefp.asm", "asm/codefp0.asm", "asm/codefp1.asm", "asm/codefp2.asm",
+	"asm/codefp3.asm", "asm/codefp_fma.asm", "asm/codefp_loop.asm", "asm/codefp_unroll.asm", "asm/codefp_waw.asm",
+	"asm/vector.asm", "bin/workloads/matmul.asm", "bin/workloads/dot.asm", "bin/workloads/stencil.asm",
+	"bin/workloads/chase.asm", "bin/workloads/reduce.asm", "bin/workloads/sort.asm"};
+#else
+static const char *default_kernels[] = {"asm/code.asm", "asm/control_dep.asm", "asm/data_dep1.asm",
+	"asm/data_dep2.asm", "asm/no_dep.asm", "asm/sort.asm", "bin/workloads/stencil_int.asm", "bin/workloads/chase_int.asm",
+	"bin/workloads/reduce_int.asm", "bin/workloads/sort.asm"};
+#endif
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* loads the data image of a generated workload (<kernel>.img, see gen_workload), if any */
+static void load_image(simulator_t *mips, const char *kernel){
+	string image(kernel);
+	if (image.size() > 4 && image.compare(image.size() - 4, 4, ".asm") == 0) image.erase(image.size() - 4);
+	image += ".img";
+	FILE *f = fopen(image.c_str(), "rb");
+	if (f == NULL) return;
+	fclose(f);
+	mips->load_data_image(image.c_str(), WORKLOAD_DATA_BASE);
+}
+
+/* instantiates the simulator, loads the kernel and initializes registers and data memory */
+static simulator_t *setup(const char *kernel){
+	unsigned i, j;
+#ifdef BENCH_FP
+	simulator_t *mips = new simulator_t(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+	mips->init_exec_unit(FMA, 6, 1);
+	mips->init_exec_unit(VECTOR_ADDER, 4, 1);
+	mips->init_exec_unit(VECTOR_MULTIPLIER, 6, 1);
+	mips->init_exec_unit(VECTOR_MEMORY, 1, 1);
+	mips->set_vector_length(4);
+	mips->load_program(kernel, 0x10000000);
+	for (i = 0; i < 0x40; i += 4) mips->write_memory(i, float2unsigned(1.0));
+	for (i = 0xA000, j=1; i < 0xA040; i+=4, j++) mips->write_memory(i, float2unsigned((float)j/2));
+	for (i = 0xB000, j=1; i < 0xB040; i+=4, j++) mips->write_memory(i, float2unsigned((float)j*10));
+	for (i = 0; i < 32; i++) mips->set_int_register(i, 0);
+	for (i = 0; i < 32; i++) mips->set_fp_register(i, (float)i);
+#else
+	simulator_t *mips = new simulator_t(1024*1024, 2);
+	mips->load_program(kernel, 0x10000000);
+	for (i = 0, j=10; i < 0x40; i+=4, j+=10) mips->write_memory(i, j);
+	for (i = 0xA000, j=10; i < 0xA040; i+=4, j--) mips->write_memory(i, j);
+	for (i = 0; i < 32; i++) mips->set_gp_register(i, 0);
+#endif
+	load_image(mips, kernel);
+	return mips;
+}
+
+typedef struct{
+	double mean;
+	double stddev;
+	double min;
+	double max;
+} summary_t;
+
+static summary_t summarize(const vector<double> &samples){
+	summary_t s = {0.0, 0.0, 0.0, 0.0};
+	if (samples.empty()) return s;
+	s.min = s.max = samples[0];
+	for (unsigned i=0; i<samples.size(); i++){
+		s.mean += samples[i];
+		if (samples[i] < s.min) s.min = samples[i];
+		if (samples[i] > s.max) s.max = samples[i];
+	}
+	s.mean /= samples.size();
+	if (samples.size() > 1){
+		for (unsigned i=0; i<samples.size(); i++) s.stddev += (samples[i] - s.mean) * (samples[i] - s.mean);
+		s.stddev = sqrt(s.stddev / (samples.size() - 1));
+	}
+	return s;
+}
+
+static void print_summary(const char *name, const summary_t &s){
+	printf("\"%s\": {\"mean\": %.1f, \"stddev\": %.1f, \"min\": %.1f, \"max\": %.1f}", name, s.mean, s.stddev, s.min, s.max);
+}
+
+/* one repetition: runs the kernel to completion as many times as needed to simulate "target" cycles;
+   returns the time spent in run() only, so that instantiating and loading the simulator is not measured
+   (the counters are read as deltas, since sim_pipe does not clear them across instances) */
+static double repetition(const char *kernel, unsigned long long target, unsigned long long &cycles, unsigned long long &instructions, unsigned &runs){
+	double elapsed = 0.0;
+	cycles = instructions = 0;
+	runs = 0;
+	while (cycles < target){
+		simulator_t *mips = setup(kernel);
+		unsigned c0 = mips->get_clock_cycles();
+		unsigned i0 = mips->get_instructions_executed();
+		double start = now();
+		mips->run();
+		elapsed += now() - start;
+		cycles += mips->get_clock_cycles() - c0;
+		instructions += mips->get_instructions_executed() - i0;
+		runs++;
+		delete mips;
+	}
+	return elapsed;
+}
+
+#ifdef BENCH_FP
+static sim_pipe_fp *sampling_setup(void *kernel){
+	return setup((const char*)kernel);
+}
+
+/* whole kernel simulated in detail and sampled, instantiation included: the fastest of "repetitions"
+   times of each; returns false if the kernel is long enough to be checked but the sampling was not faster */
+static bool compare_sampling(const char *kernel, unsigned repetitions, double &setup_time, double &detailed_time,
+                             double &sampled_time, unsigned &samples){
+	setup_time = detailed_time = sampled_time = HUGE_VAL;
+	for (unsigned r=0; r<repetitions; r++){
+		double start = now();
+		simulator_t *mips = setup(kernel);
+		setup_time = fmin(setup_time, now() - start);
+		mips->run();
+		delete mips;
+		detailed_time = fmin(detailed_time, now() - start);
+		start = now();
+		sampling_result_t result = run_sampled(sampling_setup, (void*)kernel, sampling_defaults());
+		sampled_time = fmin(sampled_time, now() - start);
+		samples = result.samples;
+	}
+	return samples == 0 || detailed_time < SAMPLING_MIN_RATIO * setup_time || sampled_time < detailed_time;
+}
+#endif
+
+int main(int argc, char **argv){
+
+	unsigned long long target = 100000;
+	unsigned warmup = 1;
+	unsigned repetitions = 5;
+#ifdef BENCH_FP
+	bool sampling = false;
+#endif
+	bool failed = false;
+	vector<const char*> kernels;
+
+	for (int a=1; a<argc; a++){
+		if (!strcmp(argv[a], "-c") && a+1 < argc) target = strtoull(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-w") && a+1 < argc) warmup = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-r") && a+1 < argc) repetitions = strtoul(argv[++a], NULL, 0);
+#ifdef BENCH_FP
+		else if (!strcmp(argv[a], "-s")) sampling = true;
+#endif
+		else if (argv[a][0] == '-'){
+			fprintf(stderr, "usage: %s [-c cycles] [-w warmup] [-r repetitions]" SIMULATOR_OPTIONS " [kernel.asm ...]\n", argv[0]);
+			exit(-1);
+		}else kernels.push_back(argv[a]);
+	}
+	if (kernels.empty()) kernels.assign(default_kernels, default_kernels + sizeof(default_kernels)/sizeof(default_kernels[0]));
+	if (target == 0 || repetitions == 0){
+		fprintf(stderr, "ERROR:: the number of cycles and of repetitions must be at least 1\n");
+		exit(-1);
+	}
+
+	printf("{\"simulator\": \"%s\", \"target_cycles\": %llu, \"warmup\": %u, \"repetitions\": %u, \"kernels\": [",
+	       SIMULATOR_NAME, target, warmup, repetitions);
+
+	vector<double> all_cps, all_ips;
+	for (unsigned k=0; k<kernels.size(); k++){
+		unsigned long long cycles, instructions;
+		unsigned runs;
+		vector<double> cps, ips;
+
+		for (unsigned w=0; w<warmup; w++) repetition(kernels[k], target, cycles, instructions, runs);
+		for (unsigned r=0; r<repetitions; r++){
+			double elapsed = repetition(kernels[k], target, cycles, instructions, runs);
+			if (elapsed <= 0.0) elapsed = 1e-6;
+			cps.push_back(cycles / elapsed);
+			ips.push_back(instructions / elapsed);
+		}
+		summary_t c = summarize(cps);
+		summary_t i = summarize(ips);
+		all_cps.push_back(c.mean);
+		all_ips.push_back(i.mean);
+
+		printf("%s\n  {\"kernel\": \"%s\", \"runs\": %u, \"cycles\": %llu, \"instructions\": %llu, ",
+		       k ? "," : "", kernels[k], runs, cycles, instructions);
+		print_summary("cycles_per_second", c);
+		printf(", ");
+		print_summary("instructions_per_second", i);
+#ifdef BENCH_FP
+		if (sampling){
+			double setup_time, detailed_time, sampled_time;
+			unsigned samples;
+			if (!compare_sampling(kernels[k], repetitions, setup_time, detailed_time, sampled_time, samples)){
+				fprintf(stderr, "ERROR:: sampling %s takes %.4f s, simulating it in detail %.4f s\n", kernels[k], sampled_time, detailed_time);
+				failed = true;
+			}
+			printf(", \"samples\": %u, \"setup_seconds\": %.4f, \"detailed_seconds\": %.4f, \"sampled_seconds\": %.4f",
+			       samples, setup_time, detailed_time, sampled_time);
+		}
+#endif
+		printf("}");
+	}
+
+	// geometric mean over the kernels, so that no single kernel dominates the figure
+	double gc = 0.0, gi = 0.0;
+	for (unsigned k=0; k<all_cps.size(); k++){
+		gc += log(all_cps[k]);
+		gi += (all_ips[k] > 0.0) ? log(all_ips[k]) : 0.0;
+	}
+	printf("\n], \"geomean_cycles_per_second\": %.1f, \"geomean_instructions_per_second\": %.1f}\n",
+	       exp(gc / all_cps.size()), exp(gi / all_ips.size()));
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,402 @@
+/* Synthetic workload generator.
+ *
+ * Emits a parameterized program in the load_program dialect (<prefix>.asm) and the matching
+ * data image (<prefix>.img): the raw content of data memory from the base address onwards,
+ * little endian, with the words not initialized by the generator set to 0xFF as after reset().
+ *
+ * usage: gen_workload <kernel> [-n size] [-d distance] [-f fp_percent] [-s seed] [-b base] -o prefix
+ *
+ * kernels:
+ * - matmul:  C = A * B with N x N single precision matrices (n = N)
+ * - dot:     dot product of two n-element single precision vectors
+ * - stencil: 3-point stencil (sum of the neighbours, times 1/3 in FP) over n elements
+ * - chase:   pointer chase over linked lists of n nodes in total, accumulating a value per node
+ * - reduce:  sum of n elements
+ * - sort:    bubble sort of n integers (data-dependent branches)
+ *
+ * The dependency distance d (1..8) is the number of independent chains each loop iteration
+ * works on: the data is split in d rows (d lists for chase, d partial sums for matmul and dot),
+ * and the loads, the arithmetic and the stores of the d chains are interleaved, so that the
+ * consumer of a value is d instructions away from its producer.
+ * The FP mix is the percentage of those chains that use FP data and instructions (the others
+ * use integer data and instructions); matmul and dot are always FP, sort is always integer and
+ * uses neither parameter. Programs with an FP mix of 0 only use the sim_pipe instruction set.
+ *
+ * Data layout (from the base address): word 0 holds 0.0 and word 1 holds 1/3 (FP constants),
+ * the results start at base+0x10 and the input data at base+0x100.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#define MAX_DISTANCE 8
+#define MAX_PROGRAM_SIZE 1024   //PROGRAM_SIZE in the simulators
+#define UNDEFINED_WORD 0xFFFFFFFF   //content of data memory after reset()
+
+#define CONST_ZERO  0x0
+#define CONST_THIRD 0x4
+#define RESULTS     0x10
+#define DATA        0x100
+
+typedef struct{
+	unsigned size;
+	unsigned distance;
+	unsigned fp_percent;
+	unsigned seed;
+	unsigned base;
+} params_t;
+
+static vector<string> program;
+static vector<unsigned> image;   //data image, one word per entry from the base address
+static params_t params;
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* appends an instruction, optionally labelled */
+static void emit(const char *label, const char *format, ...) __attribute__((format(printf, 2, 3)));
+static void emit(const char *label, const char *format, ...){
+	char buffer[128];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	program.push_back(string(label ? label : "") + (label ? ":" : "") + "\t" + buffer);
+}
+
+/* absolute address (as an immediate) of an offset from the base address */
+static unsigned addr(unsigned offset){
+	return params.base + offset;
+}
+
+static void word(unsigned offset, unsigned value){
+	unsigned i = offset / 4;
+	if (image.size() <= i) image.resize(i + 1, UNDEFINED_WORD);
+	image[i] = value;
+}
+
+static bool fp_chain(unsigned chain){
+	return chain < (params.distance * params.fp_percent + 50) / 100;
+}
+
+/* a data value for a chain: small integers, or halves in FP */
+static unsigned value(unsigned chain){
+	int v = rand() % 16 + 1;
+	return fp_chain(chain) ? float2unsigned((float)v / 2) : (unsigned)v;
+}
+
+static unsigned ceil_div(unsigned a, unsigned b){
+	return (a + b - 1) / b;
+}
+
+/* accumulator j: R10+j / F1+j; temporary j: R20+j / F10+j */
+static void init_accumulator(unsigned j){
+	if (fp_chain(j)) emit(NULL, "LWS\tF%u 0x%X(R0)", 1 + j, addr(CONST_ZERO));
+	else emit(NULL, "ADD\tR%u R0 R0", 10 + j);
+}
+
+static void store_accumulator(unsigned j){
+	if (fp_chain(j)) emit(NULL, "SWS\tF%u 0x%X(R0)", 1 + j, addr(RESULTS + 4 * j));
+	else emit(NULL, "SW\tR%u 0x%X(R0)", 10 + j, addr(RESULTS + 4 * j));
+}
+
+static void accumulate(unsigned j){
+	if (fp_chain(j)) emit(NULL, "ADDS\tF%u F%u F%u", 1 + j, 1 + j, 10 + j);
+	else emit(NULL, "ADD\tR%u R%u R%u", 10 + j, 10 + j, 20 + j);
+}
+
+static void load_temporary(unsigned j, unsigned offset, unsigned base_reg){
+	if (fp_chain(j)) emit(NULL, "LWS\tF%u 0x%X(R%u)", 10 + j, offset, base_reg);
+	else emit(NULL, "LW\tR%u 0x%X(R%u)", 20 + j, offset, base_reg);
+}
+
+/* sum of n elements, split in d rows of m elements */
+static void gen_reduce(){
+	unsigned d = params.distance, m = ceil_div(params.size, d);
+	for (unsigned j=0; j<d; j++)
+		for (unsigned i=0; i<m; i++) word(DATA + 4 * (j * m + i), value(j));
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	emit(NULL, "ADDI\tR1 R0 0x%X", addr(DATA));
+	emit(NULL, "ADDI\tR2 R0 %u", m);
+	for (unsigned j=0; j<d; j++) init_accumulator(j);
+	for (unsigned j=0; j<d; j++){
+		if (j == 0) program.push_back("L_REDUCE:");
+		load_temporary(j, 4 * j * m, 1);
+	}
+	for (unsigned j=0; j<d; j++) accumulate(j);
+	emit(NULL, "ADDI\tR1 R1 0x4");
+	emit(NULL, "SUBI\tR2 R2 1");
+	emit(NULL, "BNEZ\tR2 L_REDUCE");
+	for (unsigned j=0; j<d; j++) store_accumulator(j);
+}
+
+/* dot product of two n-element vectors, with d partial sums */
+static void gen_dot(){
+	unsigned d = params.distance, m = ceil_div(params.size, d);
+	params.fp_percent = 100;
+	unsigned b = DATA + 4 * d * m;
+	for (unsigned i=0; i<d*m; i++){
+		word(DATA + 4 * i, value(0));
+		word(b + 4 * i, value(0));
+	}
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	emit(NULL, "ADDI\tR1 R0 0x%X", addr(DATA));
+	emit(NULL, "ADDI\tR2 R0 %u", m);
+	for (unsigned j=0; j<d; j++) init_accumulator(j);
+	for (unsigned j=0; j<d; j++){
+		if (j == 0) program.push_back("L_DOT:");
+		emit(NULL, "LWS\tF%u 0x%X(R1)", 10 + j, 4 * j * m);
+	}
+	for (unsigned j=0; j<d; j++) emit(NULL, "LWS\tF%u 0x%X(R1)", 20 + j, b - DATA + 4 * j * m);
+	for (unsigned j=0; j<d; j++) emit(NULL, "MULTS\tF%u F%u F%u", 10 + j, 10 + j, 20 + j);
+	for (unsigned j=0; j<d; j++) accumulate(j);
+	emit(NULL, "ADDI\tR1 R1 0x4");
+	emit(NULL, "SUBI\tR2 R2 1");
+	emit(NULL, "BNEZ\tR2 L_DOT");
+	for (unsigned j=1; j<d; j++) emit(NULL, "ADDS\tF1 F1 F%u", 1 + j);
+	store_accumulator(0);
+}
+
+/* 3-point stencil over d rows of m elements (plus two halo elements per row);
+   row j uses R/F 3j+5 .. 3j+7 (R5..R28, F5..F28) */
+static void gen_stencil(){
+	unsigned d = params.distance, m = ceil_div(params.size, d);
+	unsigned in = DATA, out = DATA + 4 * d * (m + 2);
+	for (unsigned j=0; j<d; j++)
+		for (unsigned i=0; i<m+2; i++) word(in + 4 * (j * (m + 2) + i), value(j));
+	word(out + 4 * (d * m - 1), UNDEFINED_WORD);   //the image covers the output as well
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	emit(NULL, "ADDI\tR1 R0 0x%X", addr(in));
+	emit(NULL, "ADDI\tR2 R0 %u", m);
+	if (fp_chain(0)) emit(NULL, "LWS\tF30 0x%X(R0)", addr(CONST_THIRD));
+	for (unsigned k=0; k<3; k++){
+		for (unsigned j=0; j<d; j++){
+			if (k == 0 && j == 0) program.push_back("L_STENCIL:");
+			char c = fp_chain(j) ? 'F' : 'R';
+			emit(NULL, "%s\t%c%u 0x%X(R1)", fp_chain(j) ? "LWS" : "LW", c, 3 * j + 5 + k, 4 * (j * (m + 2) + k));
+		}
+	}
+	for (unsigned k=1; k<3; k++){
+		for (unsigned j=0; j<d; j++){
+			char c = fp_chain(j) ? 'F' : 'R';
+			emit(NULL, "%s\t%c%u %c%u %c%u", fp_chain(j) ? "ADDS" : "ADD", c, 3 * j + 5, c, 3 * j + 5, c, 3 * j + 5 + k);
+		}
+	}
+	for (unsigned j=0; j<d; j++)
+		if (fp_chain(j)) emit(NULL, "MULTS\tF%u F%u F30", 3 * j + 5, 3 * j + 5);
+	for (unsigned j=0; j<d; j++){
+		char c = fp_chain(j) ? 'F' : 'R';
+		emit(NULL, "%s\t%c%u 0x%X(R1)", fp_chain(j) ? "SWS" : "SW", c, 3 * j + 5, out - in + 4 * j * m);
+	}
+	emit(NULL, "ADDI\tR1 R1 0x4");
+	emit(NULL, "SUBI\tR2 R2 1");
+	emit(NULL, "BNEZ\tR2 L_STENCIL");
+}
+
+/* pointer chase over d lists of m nodes {next, value}, the nodes of all the lists being randomly
+   placed in the node pool; the list heads are in the first d words of the data */
+static void gen_chase(){
+	unsigned d = params.distance, m = ceil_div(params.size, d);
+	unsigned pool = DATA + 4 * MAX_DISTANCE;
+	vector<unsigned> slots(d * m);
+	for (unsigned i=0; i<slots.size(); i++) slots[i] = i;
+	for (unsigned i=slots.size(); i>1; i--) swap(slots[i - 1], slots[rand() % i]);
+	for (unsigned j=0; j<d; j++){
+		for (unsigned i=0; i<m; i++){
+			unsigned node = pool + 8 * slots[j * m + i];
+			if (i == 0) word(DATA + 4 * j, addr(node));
+			word(node, (i + 1 < m) ? addr(pool + 8 * slots[j * m + i + 1]) : 0);
+			word(node + 4, value(j));
+		}
+	}
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	for (unsigned j=0; j<d; j++) emit(NULL, "LW\tR%u 0x%X(R0)", 1 + j, addr(DATA + 4 * j));
+	for (unsigned j=0; j<d; j++) init_accumulator(j);
+	for (unsigned j=0; j<d; j++){
+		if (j == 0) program.push_back("L_CHASE:");
+		load_temporary(j, 4, 1 + j);
+	}
+	for (unsigned j=0; j<d; j++) emit(NULL, "LW\tR%u 0x0(R%u)", 1 + j, 1 + j);
+	for (unsigned j=0; j<d; j++) accumulate(j);
+	emit(NULL, "BNEZ\tR1 L_CHASE");
+	for (unsigned j=0; j<d; j++) store_accumulator(j);
+}
+
+/* bubble sort of n integers, in place */
+static void gen_sort(){
+	unsigned n = params.size;
+	if (n < 2){
+		fprintf(stderr, "ERROR:: sort needs at least 2 elements\n");
+		exit(-1);
+	}
+	for (unsigned i=0; i<n; i++) word(DATA + 4 * i, rand() % 1000);
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	emit(NULL, "ADDI\tR1 R0 %u", n - 1);
+	emit("L_OUTER", "ADDI\tR4 R0 0x%X", addr(DATA));
+	emit(NULL, "ADD\tR2 R1 R0");
+	emit(NULL, "LW\tR3 0x0(R4)");
+	emit("L_INNER", "LW\tR5 0x4(R4)");
+	emit(NULL, "SUB\tR8 R3 R5");
+	emit(NULL, "BLEZ\tR8 L_NOSWAP");
+	emit(NULL, "SW\tR5 0x0(R4)");
+	emit(NULL, "SW\tR3 0x4(R4)");
+	emit(NULL, "ADD\tR5 R3 R0");
+	emit("L_NOSWAP", "ADD\tR3 R5 R0");
+	emit(NULL, "ADDI\tR4 R4 0x4");
+	emit(NULL, "SUBI\tR2 R2 1");
+	emit(NULL, "BNEZ\tR2 L_INNER");
+	emit(NULL, "SUBI\tR1 R1 1");
+	emit(NULL, "BNEZ\tR1 L_OUTER");
+}
+
+/* C = A * B (N x N); the inner product is split in d partial sums:
+   R1 row of A, R2 column of B, R3 element of C, R4..R6 loop counters, R7/R8 inner pointers */
+static void gen_matmul(){
+	unsigned n = params.size, d = params.distance;
+	params.fp_percent = 100;
+	if (n % d != 0){
+		fprintf(stderr, "ERROR:: matmul size must be a multiple of the dependency distance\n");
+		exit(-1);
+	}
+	unsigned a = DATA, b = DATA + 4 * n * n, c = DATA + 8 * n * n;
+	for (unsigned i=0; i<n*n; i++){
+		word(a + 4 * i, value(0));
+		word(b + 4 * i, value(0));
+	}
+	word(c + 4 * (n * n - 1), UNDEFINED_WORD);   //the image covers the output as well
+
+	emit(NULL, "XOR\tR0 R0 R0");
+	emit(NULL, "ADDI\tR1 R0 0x%X", addr(a));
+	emit(NULL, "ADDI\tR3 R0 0x%X", addr(c));
+	emit(NULL, "ADDI\tR4 R0 %u", n);
+	emit("L_ROW", "ADDI\tR2 R0 0x%X", addr(b));
+	emit(NULL, "ADDI\tR5 R0 %u", n);
+	emit("L_COL", "ADD\tR7 R1 R0");
+	emit(NULL, "ADD\tR8 R2 R0");
+	emit(NULL, "ADDI\tR6 R0 %u", n / d);
+	for (unsigned j=0; j<d; j++) init_accumulator(j);
+	for (unsigned j=0; j<d; j++){
+		if (j == 0) program.push_back("L_INNER:");
+		emit(NULL, "LWS\tF%u 0x%X(R7)", 10 + j, 4 * j);
+	}
+	for (unsigned j=0; j<d; j++) emit(NULL, "LWS\tF%u 0x%X(R8)", 20 + j, 4 * j * n);
+	for (unsigned j=0; j<d; j++) emit(NULL, "MULTS\tF%u F%u F%u", 10 + j, 10 + j, 20 + j);
+	for (unsigned j=0; j<d; j++) accumulate(j);
+	emit(NULL, "ADDI\tR7 R7 0x%X", 4 * d);
+	emit(NULL, "ADDI\tR8 R8 0x%X", 4 * d * n);
+	emit(NULL, "SUBI\tR6 R6 1");
+	emit(NULL, "BNEZ\tR6 L_INNER");
+	for (unsigned j=1; j<d; j++) emit(NULL, "ADDS\tF1 F1 F%u", 1 + j);
+	emit(NULL, "SWS\tF1 0x0(R3)");
+	emit(NULL, "ADDI\tR3 R3 0x4");
+	emit(NULL, "ADDI\tR2 R2 0x4");
+	emit(NULL, "SUBI\tR5 R5 1");
+	emit(NULL, "BNEZ\tR5 L_COL");
+	emit(NULL, "ADDI\tR1 R1 0x%X", 4 * n);
+	emit(NULL, "SUBI\tR4 R4 1");
+	emit(NULL, "BNEZ\tR4 L_ROW");
+}
+
+/* a label alone on a line is merged into the following instruction (load_program expects both on the same line) */
+static void write_program(const char *filename){
+	FILE *f = fopen(filename, "w");
+	if (f == NULL){
+		fprintf(stderr, "ERROR:: cannot open %s\n", filename);
+		exit(-1);
+	}
+	string label;
+	unsigned size = 0;
+	for (unsigned i=0; i<program.size(); i++){
+		if (program[i][program[i].size() - 1] == ':'){
+			label = program[i];
+			continue;
+		}
+		fprintf(f, "%s%s\n", label.c_str(), program[i].c_str());
+		label = "";
+		size++;
+	}
+	fprintf(f, "\tEOP\n");
+	fclose(f);
+	if (size + 1 > MAX_PROGRAM_SIZE){
+		fprintf(stderr, "ERROR:: program of %u instructions, larger than %u\n", size + 1, MAX_PROGRAM_SIZE);
+		exit(-1);
+	}
+}
+
+static void write_image(const char *filename){
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL){
+		fprintf(stderr, "ERROR:: cannot open %s\n", filename);
+		exit(-1);
+	}
+	for (unsigned i=0; i<image.size(); i++){
+		unsigned char bytes[4] = {(unsigned char)(image[i] & 0xFF), (unsigned char)((image[i] >> 8) & 0xFF),
+		                          (unsigned char)((image[i] >> 16) & 0xFF), (unsigned char)((image[i] >> 24) & 0xFF)};
+		fwrite(bytes, 1, 4, f);
+	}
+	fclose(f);
+}
+
+static void usage(const char *name){
+	fprintf(stderr, "usage: %s matmul|dot|stencil|chase|reduce|sort [-n size] [-d distance] [-f fp_percent] [-s seed] [-b base] -o prefix\n", name);
+	exit(-1);
+}
+
+int main(int argc, char **argv){
+	if (argc < 2) usage(argv[0]);
+	const char *kernel = argv[1];
+	const char *prefix = NULL;
+	params.size = 64;
+	params.distance = 1;
+	params.fp_percent = 0;
+	params.seed = 1;
+	params.base = 0xA000;
+
+	for (int a=2; a<argc; a++){
+		if (a + 1 >= argc) usage(argv[0]);
+		if (!strcmp(argv[a], "-n")) params.size = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-d")) params.distance = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-f")) params.fp_percent = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-s")) params.seed = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-b")) params.base = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-o")) prefix = argv[++a];
+		else usage(argv[0]);
+	}
+	if (prefix == NULL || params.size == 0) usage(argv[0]);
+	if (params.distance < 1 || params.distance > MAX_DISTANCE || params.fp_percent > 100){
+		fprintf(stderr, "ERROR:: the dependency distance must be in 1..%u and the FP mix in 0..100\n", MAX_DISTANCE);
+		exit(-1);
+	}
+	srand(params.seed);
+
+	word(CONST_ZERO, float2unsigned(0.0));
+	word(CONST_THIRD, float2unsigned(1.0 / 3));
+
+	if (!strcmp(kernel, "matmul")) gen_matmul();
+	else if (!strcmp(kernel, "dot")) gen_dot();
+	else if (!strcmp(kernel, "stencil")) gen_stencil();
+	else if (!strcmp(kernel, "chase")) gen_chase();
+	else if (!strcmp(kernel, "reduce")) gen_reduce();
+	else if (!strcmp(kernel, "sort")) gen_sort();
+	else usage(argv[0]);
+
+	write_program((string(prefix) + ".asm").c_str());
+	write_image((string(prefix) + ".img").c_str());
+	printf("%s: %s.asm, %s.img (%lu bytes at 0x%X)\n", kernel, prefix, prefix, (unsigned long)image.size() * 4, params.base);
+}
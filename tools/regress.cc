@@ -0,0 +1,391 @@
+/* Golden-output regression runner.
+ *
+ * The same source is compiled twice: as is for sim_pipe (bin/regress_sim_pipe) and with
+ * -DREGRESS_FP for sim_pipe_fp (bin/regress_sim_pipe_fp).
+ *
+ * Each case replays the scenario of a testcase (program, execution units, data and registers),
+ * one cycle at a time up to EOP, and records a digest of the machine state after every cycle:
+ * one 64-bit FNV-1a hash per field (special purpose registers of all the stages, integer, FP and
+ * vector register files) plus the incrementally maintained digest of the whole data memory
+ * (memory_hash()). The digests are
+ * compared with the goldens in testcases/golden/<case>.digest, reporting the first divergent
+ * cycle and field. All the cases run concurrently, one thread each.
+ *
+ * usage: regress [-u] [case ...]     (-u rewrites the goldens instead of checking them)
+ */
+
+#ifdef REGRESS_FP
+#include "sim_pipe_fp.h"
+typedef sim_pipe_fp simulator_t;
+#else
+#include "sim_pipe.h"
+typedef sim_pipe simulator_t;
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+#define GOLDEN_DIR "testcases/golden/"
+#define MAX_CYCLES 100000   //a case not reaching EOP within this many cycles fails
+
+#ifdef REGRESS_FP
+static const char *field_names[] = {"sp", "int", "fp", "vector", "memory"};
+#else
+static const char *field_names[] = {"sp", "int", "memory"};
+#endif
+#define NUM_FIELDS (sizeof(field_names)/sizeof(field_names[0]))
+
+typedef unsigned long long digest_t;
+
+typedef struct{
+	const char *name;
+	simulator_t *(*setup)();
+} case_t;
+
+/* per-case outcome, filled by the case's thread */
+typedef struct{
+	vector<vector<digest_t> > digests;   //one entry per cycle, the first one before the first cycle
+	bool terminated;
+	string message;
+	bool passed;
+} result_t;
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* ========================== cases ========================== */
+
+#ifdef REGRESS_FP
+
+static simulator_t *new_fp(unsigned latency, unsigned int_lat, unsigned add_lat, unsigned mult_lat, unsigned mult_units, unsigned div_lat){
+	simulator_t *mips = new simulator_t(1024*1024, latency);
+	mips->init_exec_unit(INTEGER, int_lat, 1);
+	mips->init_exec_unit(ADDER, add_lat, 1);
+	mips->init_exec_unit(MULTIPLIER, mult_lat, mult_units);
+	mips->init_exec_unit(DIVIDER, div_lat, 1);
+	return mips;
+}
+
+/* testcase_fp0 and testcase_fp6 */
+static simulator_t *setup_loop(const char *program, bool r4){
+	unsigned i, j;
+	simulator_t *mips = new_fp(9, 1, 4, 7, 1, 25);
+	mips->load_program(program, 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	mips->set_fp_register(1, 0.0);
+	if (r4) mips->set_int_register(4, 1);
+	return mips;
+}
+
+/* testcase_fp1 .. testcase_fp5 */
+static simulator_t *setup_straight(const char *program, unsigned mult_units, unsigned fp_regs){
+	unsigned i, j;
+	simulator_t *mips = new_fp(0, 0, 4, 9, mult_units, 19);
+	mips->load_program(program, 0x10000000);
+	for (i = 0xA000, j=1; i<0xA010; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+	mips->set_int_register(0,0);
+	mips->set_int_register(1,0xA000);
+	for (i=0; i<fp_regs; i++) mips->set_fp_register(i, (float)i);
+	return mips;
+}
+
+/* testcase_fp9 .. testcase_fp11 */
+static simulator_t *setup_transformed(const char *program, unsigned unroll, bool schedule, unsigned registers){
+	unsigned i, j;
+	simulator_t *mips = new_fp(2, 0, 4, 9, 1, 19);
+	mips->init_exec_unit(FMA, 6, 1);
+	mips->load_program(program, 0x10000000);
+	if (unroll > 1) mips->unroll_loops(unroll);
+	if (registers) mips->enable_register_renaming(registers);
+	if (schedule) mips->schedule_program();
+	for (i = 0xA000, j=1; i<0xA030; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	for (i = 0xB000, j=1; i<0xB030; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+	mips->set_int_register(0,0);
+	mips->set_int_register(1,0xA000);
+	mips->set_int_register(4,1);
+	for (i=0; i<12; i++) mips->set_fp_register(i, (float)i);
+	return mips;
+}
+
+static simulator_t *case_fp0(){ return setup_loop("asm/codefp.asm", true); }
+static simulator_t *case_fp1(){ return setup_straight("asm/codefp0.asm", 1, 10); }
+static simulator_t *case_fp2(){ return setup_straight("asm/codefp0.asm", 2, 10); }
+static simulator_t *case_fp3(){ return setup_straight("asm/codefp1.asm", 1, 10); }
+static simulator_t *case_fp4(){ return setup_straight("asm/codefp2.asm", 1, 10); }
+static simulator_t *case_fp5(){ return setup_straight("asm/codefp3.asm", 1, 12); }
+static simulator_t *case_fp6(){ return setup_loop("asm/codefp_loop.asm", false); }
+
+/* testcase_fp7 */
+static simulator_t *case_fp7(){
+	unsigned i, j;
+	simulator_t *mips = new_fp(2, 0, 4, 9, 1, 19);
+	mips->init_exec_unit(VECTOR_ADDER, 4, 1);
+	mips->init_exec_unit(VECTOR_MULTIPLIER, 6, 1);
+	mips->init_exec_unit(VECTOR_MEMORY, 1, 1);
+	mips->set_vector_length(4);
+	mips->load_program("asm/vector.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j));
+	for (i = 0xB000, j=1; i<0xB010; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	return mips;
+}
+
+/* testcase_fp8 */
+static simulator_t *case_fp8(){
+	unsigned i, j;
+	simulator_t *mips = new_fp(0, 0, 4, 9, 1, 19);
+	mips->init_exec_unit(FMA, 6, 1);
+	mips->load_program("asm/codefp_fma.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j));
+	for (i = 0xB000, j=1; i<0xB010; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	mips->set_fp_register(3, 0.0);
+	return mips;
+}
+
+static simulator_t *case_fp9_scheduled(){ return setup_transformed("asm/codefp.asm", 1, true, 0); }
+static simulator_t *case_fp10_unrolled(){ return setup_transformed("asm/codefp_unroll.asm", 4, false, 0); }
+static simulator_t *case_fp10_unrolled_scheduled(){ return setup_transformed("asm/codefp_fma.asm", 4, true, 0); }
+static simulator_t *case_fp11_renamed(){ return setup_transformed("asm/codefp_waw.asm", 1, false, 64); }
+static simulator_t *case_fp11_renamed_small(){ return setup_transformed("asm/codefp_unroll.asm", 4, false, 34); }
+
+static const case_t cases[] = {
+	{"testcase_fp0", case_fp0},
+	{"testcase_fp1", case_fp1},
+	{"testcase_fp2", case_fp2},
+	{"testcase_fp3", case_fp3},
+	{"testcase_fp4", case_fp4},
+	{"testcase_fp5", case_fp5},
+	{"testcase_fp6", case_fp6},
+	{"testcase_fp7", case_fp7},
+	{"testcase_fp8", case_fp8},
+	{"testcase_fp9_scheduled", case_fp9_scheduled},
+	{"testcase_fp10_unrolled", case_fp10_unrolled},
+	{"testcase_fp10_unrolled_scheduled", case_fp10_unrolled_scheduled},
+	{"testcase_fp11_renamed", case_fp11_renamed},
+	{"testcase_fp11_renamed_small", case_fp11_renamed_small},
+};
+
+#else
+
+/* testcase1 .. testcase5 */
+static simulator_t *setup_int(const char *program, unsigned latency, unsigned first, unsigned step){
+	unsigned i, j;
+	simulator_t *mips = new simulator_t(1024*1024, latency);
+	mips->load_program(program, 0x10000000);
+	for (i=0; i<7; i++) mips->set_gp_register(i,i);
+	for (i = 0x0, j=first; i<0x20; i+=4, j+=step) mips->write_memory(i,j);
+	return mips;
+}
+
+static simulator_t *case_1(){ return setup_int("asm/no_dep.asm", 0, 10, 10); }
+static simulator_t *case_2(){ return setup_int("asm/data_dep1.asm", 0, 1, 1); }
+static simulator_t *case_3(){ return setup_int("asm/data_dep2.asm", 0, 1, 1); }
+static simulator_t *case_4(){ return setup_int("asm/control_dep.asm", 0, 1, 1); }
+static simulator_t *case_5(){ return setup_int("asm/control_dep.asm", 4, 1, 1); }
+
+/* testcase6 */
+static simulator_t *case_6(){
+	unsigned i, j;
+	simulator_t *mips = new simulator_t(1024*1024, 4);
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	return mips;
+}
+
+static const case_t cases[] = {
+	{"testcase1", case_1},
+	{"testcase2", case_2},
+	{"testcase3", case_3},
+	{"testcase4", case_4},
+	{"testcase5", case_5},
+	{"testcase6", case_6},
+};
+
+#endif
+
+#define NUM_CASES (sizeof(cases)/sizeof(cases[0]))
+
+/* ========================== digests ========================== */
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+static inline void fnv_word(digest_t &h, unsigned value){
+	for (unsigned b=0; b<4; b++){
+		h ^= (value >> (8 * b)) & 0xFF;
+		h *= FNV_PRIME;
+	}
+}
+
+static vector<digest_t> state_digest(simulator_t *mips){
+	vector<digest_t> d(NUM_FIELDS, FNV_OFFSET);
+	unsigned f = 0;
+	for (unsigned s=0; s<NUM_STAGES; s++)
+		for (unsigned r=0; r<NUM_SP_REGISTERS; r++) fnv_word(d[f], mips->get_sp_register((sp_register_t)r, (stage_t)s));
+	f++;
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+#ifdef REGRESS_FP
+		fnv_word(d[f], mips->get_int_register(r));
+#else
+		fnv_word(d[f], mips->get_gp_register(r));
+#endif
+	}
+	f++;
+#ifdef REGRESS_FP
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) fnv_word(d[f], float2unsigned(mips->get_fp_register(r)));
+	f++;
+	for (unsigned r=0; r<NUM_VECTOR_REGISTERS; r++)
+		for (unsigned e=0; e<MAX_VECTOR_LENGTH; e++) fnv_word(d[f], mips->sim_pipe_vreg_file[r].regVal[e]);
+	f++;
+#endif
+	d[f] = mips->memory_hash();
+	return d;
+}
+
+//load_program tokenizes with strtok, which is not reentrant: the setups are serialized
+static mutex setup_lock;
+
+/* runs a case one cycle at a time up to EOP, recording the digest after each cycle */
+static void run_case(const case_t *c, result_t *result){
+	setup_lock.lock();
+	simulator_t *mips = c->setup();
+	setup_lock.unlock();
+	result->digests.push_back(state_digest(mips));
+	unsigned cycles = 0;
+	while (mips->sim_pipe_pipeline_reg[WB].IR.opcode != EOP && cycles < MAX_CYCLES){
+		mips->run(1);
+		cycles++;
+		result->digests.push_back(state_digest(mips));
+	}
+	result->terminated = (mips->sim_pipe_pipeline_reg[WB].IR.opcode == EOP);
+	delete mips;
+}
+
+/* ========================== goldens ========================== */
+
+static string golden_file(const case_t &c){
+	return string(GOLDEN_DIR) + c.name + ".digest";
+}
+
+static void write_golden(const case_t &c, const result_t &result){
+	FILE *f = fopen(golden_file(c).c_str(), "w");
+	if (f == NULL){
+		fprintf(stderr, "ERROR:: cannot write %s\n", golden_file(c).c_str());
+		exit(-1);
+	}
+	fprintf(f, "# cycle");
+	for (unsigned i=0; i<NUM_FIELDS; i++) fprintf(f, " %s", field_names[i]);
+	fprintf(f, "\n");
+	for (unsigned cycle=0; cycle<result.digests.size(); cycle++){
+		fprintf(f, "%u", cycle);
+		for (unsigned i=0; i<NUM_FIELDS; i++) fprintf(f, " %016llx", result.digests[cycle][i]);
+		fprintf(f, "\n");
+	}
+	fclose(f);
+}
+
+/* compares a run with its golden; on mismatch, describes the first divergence */
+static bool check_golden(const case_t &c, const result_t &result, string &message){
+	FILE *f = fopen(golden_file(c).c_str(), "r");
+	if (f == NULL){
+		message = "no golden " + golden_file(c);
+		return false;
+	}
+	char line[512];
+	char buffer[256];
+	unsigned cycle = 0;
+	bool passed = true;
+	while (passed && fgets(line, sizeof(line), f) != NULL){
+		if (line[0] == '#') continue;
+		char *p = line;
+		strtoul(p, &p, 10);
+		if (cycle >= result.digests.size()){
+			snprintf(buffer, sizeof(buffer), "run ends at cycle %u, golden continues", (unsigned)result.digests.size() - 1);
+			message = buffer;
+			passed = false;
+			break;
+		}
+		for (unsigned i=0; i<NUM_FIELDS; i++){
+			digest_t expected = strtoull(p, &p, 16);
+			if (expected != result.digests[cycle][i]){
+				snprintf(buffer, sizeof(buffer), "first divergence at cycle %u in %s (expected %016llx, got %016llx)",
+				         cycle, field_names[i], expected, result.digests[cycle][i]);
+				message = buffer;
+				passed = false;
+				break;
+			}
+		}
+		cycle++;
+	}
+	fclose(f);
+	if (passed && cycle < result.digests.size()){
+		snprintf(buffer, sizeof(buffer), "golden ends at cycle %u, run continues", cycle - 1);
+		message = buffer;
+		passed = false;
+	}
+	return passed;
+}
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main(int argc, char **argv){
+
+	bool update = false;
+	vector<const case_t*> selected;
+	for (int a=1; a<argc; a++){
+		if (!strcmp(argv[a], "-u")){
+			update = true;
+			continue;
+		}
+		unsigned c;
+		for (c=0; c<NUM_CASES && strcmp(cases[c].name, argv[a]); c++);
+		if (c == NUM_CASES){
+			fprintf(stderr, "ERROR:: unknown case %s\n", argv[a]);
+			exit(-1);
+		}
+		selected.push_back(&cases[c]);
+	}
+	if (selected.empty())
+		for (unsigned c=0; c<NUM_CASES; c++) selected.push_back(&cases[c]);
+
+	double start = now();
+	vector<result_t> results(selected.size());
+	vector<thread> threads;
+	for (unsigned c=0; c<selected.size(); c++) threads.push_back(thread(run_case, selected[c], &results[c]));
+	for (unsigned c=0; c<threads.size(); c++) threads[c].join();
+
+	unsigned failed = 0;
+	for (unsigned c=0; c<selected.size(); c++){
+		result_t &result = results[c];
+		if (!result.terminated){
+			result.passed = false;
+			result.message = "EOP not reached";
+		}else if (update){
+			write_golden(*selected[c], result);
+			result.passed = true;
+			result.message = "golden updated";
+		}else{
+			result.passed = check_golden(*selected[c], result, result.message);
+		}
+		if (!result.passed) failed++;
+		printf("%s %s (%u cycles)%s%s\n", result.passed ? "PASS" : "FAIL", selected[c]->name,
+		       (unsigned)result.digests.size() - 1, result.message.empty() ? "" : ": ", result.message.c_str());
+	}
+	printf("%u/%u cases passed in %.1f ms\n", (unsigned)selected.size() - failed, (unsigned)selected.size(), (now() - start) * 1000);
+	return failed ? 1 : 0;
+}